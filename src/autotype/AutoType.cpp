@@ -20,9 +20,11 @@
 #include <QApplication>
 #include <QPluginLoader>
 
+#include "autotype/AutoTypeMatchIndex.h"
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/AutoTypeSelectDialog.h"
-#include "autotype/WildcardMatcher.h"
+#include "autotype/WindowPattern.h"
+#include "autotype/WindowPatternCache.h"
 #include "core/Config.h"
 #include "core/Database.h"
 #include "core/Entry.h"
@@ -43,6 +45,8 @@ AutoType::AutoType(QObject* parent, bool test)
     , m_plugin(Q_NULLPTR)
     , m_executor(Q_NULLPTR)
     , m_windowFromGlobal(0)
+    , m_windowPatterns(new WindowPatternCache(this))
+    , m_matchIndex(new AutoTypeMatchIndex(m_windowPatterns, this))
 {
     // prevent crash when the plugin has unresolved symbols
     m_pluginLoader->setLoadHints(QLibrary::ResolveAllSymbolsHint);
@@ -175,17 +179,16 @@ void AutoType::performGlobalAutoType(const QList<Database*>& dbList)
 
     m_inAutoType = true;
 
+    m_matchIndex->setDatabases(dbList);
+    QList<AutoTypeMatchIndex::Match> matches =
+            m_matchIndex->match(windowTitle, config()->get("AutoTypeEntryTitleMatch").toBool());
+
     QList<Entry*> entryList;
     QHash<Entry*, QString> sequenceHash;
 
-    Q_FOREACH (Database* db, dbList) {
-        Q_FOREACH (Entry* entry, db->rootGroup()->entriesRecursive()) {
-            QString sequence = autoTypeSequence(entry, windowTitle);
-            if (!sequence.isEmpty()) {
-                entryList << entry;
-                sequenceHash.insert(entry, sequence);
-            }
-        }
+    Q_FOREACH (const AutoTypeMatchIndex::Match& match, matches) {
+        entryList << match.entry;
+        sequenceHash.insert(match.entry, match.sequence);
     }
 
     if (entryList.isEmpty()) {
@@ -488,18 +491,13 @@ QString AutoType::autoTypeSequence(const Entry* entry, const QString& windowTitl
         return QString();
     }
 
-    bool enableSet = false;
     QString sequence;
     if (!windowTitle.isEmpty()) {
         bool match = false;
-        Q_FOREACH (const AutoTypeAssociations::Association& assoc, entry->autoTypeAssociations()->getAll()) {
-            if (windowMatches(windowTitle, assoc.window)) {
-                if (!assoc.sequence.isEmpty()) {
-                    sequence = assoc.sequence;
-                }
-                else {
-                    sequence = entry->defaultAutoTypeSequence();
-                }
+        const AutoTypeAssociations* associations = entry->autoTypeAssociations();
+        for (int i = 0; i < associations->size(); i++) {
+            if (windowMatches(windowTitle, associations, i)) {
+                sequence = associations->get(i).sequence;
                 match = true;
                 break;
             }
@@ -507,7 +505,6 @@ QString AutoType::autoTypeSequence(const Entry* entry, const QString& windowTitl
 
         if (!match && config()->get("AutoTypeEntryTitleMatch").toBool() && !entry->title().isEmpty()
                 && windowTitle.contains(entry->title(), Qt::CaseInsensitive)) {
-            sequence = entry->defaultAutoTypeSequence();
             match = true;
         }
 
@@ -515,50 +512,21 @@ QString AutoType::autoTypeSequence(const Entry* entry, const QString& windowTitl
             return QString();
         }
     }
-    else {
-        sequence = entry->defaultAutoTypeSequence();
-    }
 
     const Group* group = entry->group();
-    do {
-        if (!enableSet) {
-            if (group->autoTypeEnabled() == Group::Disable) {
-                return QString();
-            }
-            else if (group->autoTypeEnabled() == Group::Enable) {
-                enableSet = true;
-            }
-        }
-
-        if (sequence.isEmpty()) {
-            sequence = group->defaultAutoTypeSequence();
-        }
-
-        group = group->parentGroup();
-    } while (group && (!enableSet || sequence.isEmpty()));
+    if (!group->resolveAutoTypeEnabled()) {
+        return QString();
+    }
 
-    if (sequence.isEmpty() && (!entry->username().isEmpty() || !entry->password().isEmpty())) {
-        if (entry->username().isEmpty()) {
-            sequence = "{PASSWORD}{ENTER}";
-        }
-        else if (entry->password().isEmpty()) {
-            sequence = "{USERNAME}{ENTER}";
-        }
-        else {
-            sequence = "{USERNAME}{TAB}{PASSWORD}{ENTER}";
-        }
+    if (sequence.isEmpty()) {
+        sequence = AutoTypeMatchIndex::entrySequence(entry, group->resolveDefaultAutoTypeSequence());
     }
 
     return sequence;
 }
 
-bool AutoType::windowMatches(const QString& windowTitle, const QString& windowPattern)
+bool AutoType::windowMatches(const QString& windowTitle, const AutoTypeAssociations* associations, int index)
 {
-    if (windowPattern.startsWith("//") && windowPattern.endsWith("//") && windowPattern.size() >= 4) {
-        QRegExp regExp(windowPattern.mid(2, windowPattern.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
-        return regExp.exactMatch(windowTitle);
-    }
-    else {
-        return WildcardMatcher(windowTitle).match(windowPattern);
-    }
+    m_windowPatterns->compile(associations);
+    return m_windowPatterns->patterns(associations)->at(index).match(windowTitle);
 }
@@ -25,11 +25,14 @@
 #include "core/Global.h"
 
 class AutoTypeAction;
+class AutoTypeAssociations;
 class AutoTypeExecutor;
+class AutoTypeMatchIndex;
 class AutoTypePlatformInterface;
 class Database;
 class Entry;
 class QPluginLoader;
+class WindowPatternCache;
 
 class AutoType : public QObject
 {
@@ -68,7 +71,7 @@ private:
     bool parseActions(const QString& sequence, const Entry* entry, QList<AutoTypeAction*>& actions);
     QList<AutoTypeAction*> createActionFromTemplate(const QString& tmpl, const Entry* entry);
     QString autoTypeSequence(const Entry* entry, const QString& windowTitle = QString());
-    bool windowMatches(const QString& windowTitle, const QString& windowPattern);
+    bool windowMatches(const QString& windowTitle, const AutoTypeAssociations* associations, int index);
 
     bool m_inAutoType;
     Qt::Key m_currentGlobalKey;
@@ -77,6 +80,8 @@ private:
     AutoTypePlatformInterface* m_plugin;
     AutoTypeExecutor* m_executor;
     WId m_windowFromGlobal;
+    WindowPatternCache* const m_windowPatterns;
+    AutoTypeMatchIndex* const m_matchIndex;
     static AutoType* m_instance;
 
     Q_DISABLE_COPY(AutoType)
@@ -0,0 +1,277 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoTypeMatchIndex.h"
+
+#include "autotype/WindowPatternCache.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/TreeIterator.h"
+
+const int AutoTypeMatchIndex::AnchorLength = 3;
+
+AutoTypeMatchIndex::AutoTypeMatchIndex(WindowPatternCache* patternCache, QObject* parent)
+    : QObject(parent)
+    , m_patternCache(patternCache)
+    , m_dirty(true)
+{
+}
+
+void AutoTypeMatchIndex::setDatabases(const QList<Database*>& dbList)
+{
+    QList<Group*> rootGroups;
+    Q_FOREACH (Database* db, dbList) {
+        rootGroups.append(db->rootGroup());
+    }
+
+    if (dbList == m_databases && rootGroups == m_rootGroups) {
+        return;
+    }
+
+    Q_FOREACH (Database* db, m_databases) {
+        disconnect(db, Q_NULLPTR, this, Q_NULLPTR);
+    }
+
+    m_databases = dbList;
+    m_rootGroups = rootGroups;
+
+    Q_FOREACH (Database* db, m_databases) {
+        connect(db, SIGNAL(modifiedImmediate()), SLOT(invalidate()));
+        connect(db, SIGNAL(destroyed(QObject*)), SLOT(databaseDestroyed(QObject*)));
+    }
+
+    invalidate();
+}
+
+QList<AutoTypeMatchIndex::Match> AutoTypeMatchIndex::match(const QString& windowTitle, bool titleMatch)
+{
+    if (m_dirty) {
+        rebuild();
+    }
+
+    QString foldedTitle = windowTitle.toCaseFolded();
+    QMap<int, const Association*> associations;
+
+    addCandidates(m_literals, foldedTitle, windowTitle, associations);
+    for (int length = 1; length <= qMin(AnchorLength, foldedTitle.size()); length++) {
+        addCandidates(m_prefixes, foldedTitle.left(length), windowTitle, associations);
+        addCandidates(m_suffixes, foldedTitle.right(length), windowTitle, associations);
+    }
+    addCandidates(m_unanchored, windowTitle, true, associations);
+    addCandidates(m_regExps, windowTitle, true, associations);
+
+    // only the first matching association of an entry counts
+    QMap<int, QString> sequences;
+    QMapIterator<int, const Association*> i(associations);
+    while (i.hasNext()) {
+        i.next();
+        sequences.insert(i.key(), i.value()->sequence);
+    }
+
+    if (titleMatch) {
+        Q_FOREACH (int length, m_titleLengths) {
+            for (int pos = 0; pos + length <= foldedTitle.size(); pos++) {
+                QHash<QString, QVector<int> >::const_iterator titleItems =
+                        m_titles.constFind(foldedTitle.mid(pos, length));
+                if (titleItems == m_titles.constEnd()) {
+                    continue;
+                }
+
+                Q_FOREACH (int item, titleItems.value()) {
+                    if (!sequences.contains(item)) {
+                        sequences.insert(item, m_items.at(item).sequence);
+                    }
+                }
+            }
+        }
+    }
+
+    QList<Match> result;
+    QMapIterator<int, QString> j(sequences);
+    while (j.hasNext()) {
+        j.next();
+        if (!j.value().isEmpty()) {
+            Match match;
+            match.entry = m_items.at(j.key()).entry;
+            match.sequence = j.value();
+            result.append(match);
+        }
+    }
+
+    return result;
+}
+
+QString AutoTypeMatchIndex::entrySequence(const Entry* entry, const QString& groupSequence)
+{
+    QString sequence = entry->defaultAutoTypeSequence();
+    if (sequence.isEmpty()) {
+        sequence = groupSequence;
+    }
+
+    if (sequence.isEmpty() && (!entry->username().isEmpty() || !entry->password().isEmpty())) {
+        if (entry->username().isEmpty()) {
+            sequence = "{PASSWORD}{ENTER}";
+        }
+        else if (entry->password().isEmpty()) {
+            sequence = "{USERNAME}{ENTER}";
+        }
+        else {
+            sequence = "{USERNAME}{TAB}{PASSWORD}{ENTER}";
+        }
+    }
+
+    return sequence;
+}
+
+void AutoTypeMatchIndex::invalidate()
+{
+    m_dirty = true;
+}
+
+void AutoTypeMatchIndex::databaseDestroyed(QObject* db)
+{
+    int index = m_databases.indexOf(static_cast<Database*>(db));
+    if (index != -1) {
+        m_databases.removeAt(index);
+        m_rootGroups.removeAt(index);
+    }
+
+    invalidate();
+}
+
+void AutoTypeMatchIndex::rebuild()
+{
+    m_items.clear();
+    m_literals.clear();
+    m_prefixes.clear();
+    m_suffixes.clear();
+    m_unanchored.clear();
+    m_regExps.clear();
+    m_titles.clear();
+    m_titleLengths.clear();
+
+    Q_FOREACH (Group* rootGroup, m_rootGroups) {
+        GroupIterator i(rootGroup);
+        while (i.hasNext()) {
+            const Group* group = i.next();
+            if (!group->resolveAutoTypeEnabled()) {
+                continue;
+            }
+
+            QString sequence = group->resolveDefaultAutoTypeSequence();
+            Q_FOREACH (Entry* entry, group->entries()) {
+                addEntry(entry, sequence);
+            }
+        }
+    }
+
+    m_dirty = false;
+}
+
+void AutoTypeMatchIndex::addEntry(Entry* entry, const QString& groupSequence)
+{
+    if (!entry->autoTypeEnabled()) {
+        return;
+    }
+
+    Item item;
+    item.entry = entry;
+    item.sequence = entrySequence(entry, groupSequence);
+
+    int itemIndex = m_items.size();
+    m_items.append(item);
+
+    // go through the const accessor so entries without associations
+    // don't get an AutoTypeAssociations object created for them
+    const AutoTypeAssociations* associations = static_cast<const Entry*>(entry)->autoTypeAssociations();
+    if (associations->size() > 0) {
+        m_patternCache->compile(associations);
+        const QVector<WindowPattern>* patterns = m_patternCache->patterns(associations);
+        const QList<AutoTypeAssociations::Association> assocList = associations->getAll();
+        Q_ASSERT(patterns && patterns->size() == assocList.size());
+
+        for (int i = 0; i < assocList.size(); i++) {
+            Association association;
+            association.item = itemIndex;
+            association.index = i;
+            association.sequence = assocList.at(i).sequence;
+            if (association.sequence.isEmpty()) {
+                association.sequence = item.sequence;
+            }
+            association.pattern = patterns->at(i);
+
+            addAssociation(association);
+        }
+    }
+
+    QString title = entry->title().toCaseFolded();
+    if (!title.isEmpty()) {
+        if (!m_titleLengths.contains(title.size())) {
+            m_titleLengths.append(title.size());
+        }
+        m_titles[title].append(itemIndex);
+    }
+}
+
+void AutoTypeMatchIndex::addAssociation(const Association& association)
+{
+    if (association.pattern.isRegExp()) {
+        m_regExps.append(association);
+        return;
+    }
+
+    const WildcardPattern& wildcard = association.pattern.wildcardPattern();
+    if (!wildcard.hasWildcard()) {
+        m_literals[wildcard.pattern().toCaseFolded()].append(association);
+    }
+    else if (!wildcard.prefix().isEmpty()) {
+        m_prefixes[wildcard.prefix().left(AnchorLength).toCaseFolded()].append(association);
+    }
+    else if (!wildcard.suffix().isEmpty()) {
+        m_suffixes[wildcard.suffix().right(AnchorLength).toCaseFolded()].append(association);
+    }
+    else {
+        m_unanchored.append(association);
+    }
+}
+
+void AutoTypeMatchIndex::addCandidates(const QHash<QString, QVector<Association> >& associations,
+                                       const QString& key, const QString& windowTitle,
+                                       QMap<int, const Association*>& result)
+{
+    QHash<QString, QVector<Association> >::const_iterator i = associations.constFind(key);
+    if (i != associations.constEnd()) {
+        addCandidates(i.value(), windowTitle, true, result);
+    }
+}
+
+void AutoTypeMatchIndex::addCandidates(const QVector<Association>& associations, const QString& windowTitle,
+                                       bool verify, QMap<int, const Association*>& result)
+{
+    for (int i = 0; i < associations.size(); i++) {
+        const Association& association = associations.at(i);
+        if (verify && !association.pattern.match(windowTitle)) {
+            continue;
+        }
+
+        const Association* previous = result.value(association.item);
+        if (!previous || association.index < previous->index) {
+            result.insert(association.item, &association);
+        }
+    }
+}
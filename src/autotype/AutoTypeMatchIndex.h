@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_AUTOTYPEMATCHINDEX_H
+#define KEEPASSX_AUTOTYPEMATCHINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+#include "autotype/WindowPattern.h"
+#include "core/Global.h"
+
+class Database;
+class Entry;
+class Group;
+class WindowPatternCache;
+
+/**
+ * Index over the auto-type associations of all entries of a set of
+ * databases.
+ *
+ * Literal window titles are looked up in a hash, wildcard patterns are
+ * bucketed by the first or last characters of the pattern and regular
+ * expressions are kept in a list. The effective auto-type sequence of every
+ * entry is resolved when the index is built so matching a window title
+ * doesn't depend on the number of entries.
+ *
+ * The index is rebuilt on the next match after a database has been
+ * modified.
+ */
+class AutoTypeMatchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Match
+    {
+        Entry* entry;
+        QString sequence;
+    };
+
+    explicit AutoTypeMatchIndex(WindowPatternCache* patternCache, QObject* parent = Q_NULLPTR);
+
+    void setDatabases(const QList<Database*>& dbList);
+
+    /**
+     * Returns the matching entries in the order of the databases and
+     * in tree order. If titleMatch is true entries whose title is part of
+     * the window title match as well.
+     */
+    QList<AutoTypeMatchIndex::Match> match(const QString& windowTitle, bool titleMatch);
+
+    /**
+     * Returns the default auto-type sequence of the entry, falling back to
+     * groupSequence and then to a sequence that types the username and/or
+     * password of the entry.
+     */
+    static QString entrySequence(const Entry* entry, const QString& groupSequence);
+
+    static const int AnchorLength;
+
+public Q_SLOTS:
+    void invalidate();
+
+private Q_SLOTS:
+    void databaseDestroyed(QObject* db);
+
+private:
+    struct Item
+    {
+        Entry* entry;
+        QString sequence;
+    };
+
+    struct Association
+    {
+        int item;
+        int index;
+        QString sequence;
+        WindowPattern pattern;
+    };
+
+    void rebuild();
+    void addEntry(Entry* entry, const QString& groupSequence);
+    void addAssociation(const Association& association);
+    static void addCandidates(const QHash<QString, QVector<Association> >& associations, const QString& key,
+                              const QString& windowTitle, QMap<int, const Association*>& result);
+    static void addCandidates(const QVector<Association>& associations, const QString& windowTitle,
+                              bool verify, QMap<int, const Association*>& result);
+
+    WindowPatternCache* const m_patternCache;
+    QList<Database*> m_databases;
+    QList<Group*> m_rootGroups;
+    bool m_dirty;
+
+    QVector<Item> m_items;
+    QHash<QString, QVector<Association> > m_literals;
+    QHash<QString, QVector<Association> > m_prefixes;
+    QHash<QString, QVector<Association> > m_suffixes;
+    QVector<Association> m_unanchored;
+    QVector<Association> m_regExps;
+    QHash<QString, QVector<int> > m_titles;
+    QVector<int> m_titleLengths;
+};
+
+#endif // KEEPASSX_AUTOTYPEMATCHINDEX_H
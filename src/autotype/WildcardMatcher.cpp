@@ -22,76 +22,77 @@
 const QChar WildcardMatcher::Wildcard = '*';
 const Qt::CaseSensitivity WildcardMatcher::Sensitivity = Qt::CaseInsensitive;
 
-WildcardMatcher::WildcardMatcher(const QString& text)
-    : m_text(text)
+WildcardPattern::WildcardPattern(const QString& pattern)
+    : m_hasWildcard(pattern.contains(WildcardMatcher::Wildcard))
+    , m_pattern(pattern)
 {
-}
+    if (m_hasWildcard) {
+        QStringList parts = pattern.split(WildcardMatcher::Wildcard, QString::KeepEmptyParts);
+        Q_ASSERT(parts.size() >= 2);
 
-bool WildcardMatcher::match(const QString& pattern)
-{
-    m_pattern = pattern;
+        m_first = parts.takeFirst();
+        m_last = parts.takeLast();
 
-    if (patternContainsWildcard()) {
-        return matchWithWildcards();
-    }
-    else {
-        return patternEqualsText();
+        Q_FOREACH (const QString& part, parts) {
+            if (!part.isEmpty()) {
+                m_middle.append(part);
+            }
+        }
     }
 }
 
-bool WildcardMatcher::patternContainsWildcard()
+bool WildcardPattern::match(const QString& text) const
 {
-    return m_pattern.contains(Wildcard);
-}
-
-bool WildcardMatcher::patternEqualsText()
-{
-    return m_text.compare(m_pattern, Sensitivity) == 0;
-}
+    const Qt::CaseSensitivity cs = WildcardMatcher::Sensitivity;
 
-bool WildcardMatcher::matchWithWildcards()
-{
-    QStringList parts = m_pattern.split(Wildcard, QString::KeepEmptyParts);
-    Q_ASSERT(parts.size() >= 2);
+    if (!m_hasWildcard) {
+        return text.compare(m_pattern, cs) == 0;
+    }
 
-    if (startOrEndDoesNotMatch(parts)) {
+    if (!text.startsWith(m_first, cs) || !text.endsWith(m_last, cs)) {
         return false;
     }
 
-    return partsMatch(parts);
+    int index = m_first.size();
+    for (int i = 0; i < m_middle.size(); i++) {
+        const QString& part = m_middle.at(i);
+        int matchIndex = text.indexOf(part, index, cs);
+        if (matchIndex == -1) {
+            return false;
+        }
+        index = matchIndex + part.size();
+    }
+
+    // the parts must not overlap with the end of the text
+    return index <= text.size() - m_last.size();
 }
 
-bool WildcardMatcher::startOrEndDoesNotMatch(const QStringList& parts)
+bool WildcardPattern::hasWildcard() const
 {
-    return !m_text.startsWith(parts.first(), Sensitivity) ||
-           !m_text.endsWith(parts.last(), Sensitivity);
+    return m_hasWildcard;
 }
 
-bool WildcardMatcher::partsMatch(const QStringList& parts)
+QString WildcardPattern::pattern() const
 {
-    int index = 0;
-    Q_FOREACH (const QString& part, parts) {
-        int matchIndex = getMatchIndex(part, index);
-        if (noMatchFound(matchIndex)) {
-            return false;
-        }
-        index = calculateNewIndex(matchIndex, part.length());
-    }
+    return m_pattern;
+}
 
-    return true;
+QString WildcardPattern::prefix() const
+{
+    return m_first;
 }
 
-int WildcardMatcher::getMatchIndex(const QString& part, int startIndex)
+QString WildcardPattern::suffix() const
 {
-    return m_text.indexOf(part, startIndex, Sensitivity);
+    return m_last;
 }
 
-bool WildcardMatcher::noMatchFound(int index)
+WildcardMatcher::WildcardMatcher(const QString& text)
+    : m_text(text)
 {
-    return index == -1;
 }
 
-int WildcardMatcher::calculateNewIndex(int matchIndex, int partLength)
+bool WildcardMatcher::match(const QString& pattern)
 {
-    return matchIndex + partLength;
+    return WildcardPattern(pattern).match(m_text);
 }
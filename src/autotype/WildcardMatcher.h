@@ -19,6 +19,31 @@
 #define KEEPASSX_WILDCARDMATCHER_H
 
 #include <QStringList>
+#include <QVector>
+
+/**
+ * Wildcard pattern that is split into its parts once so it can be
+ * matched against many texts without allocating memory.
+ */
+class WildcardPattern
+{
+public:
+    explicit WildcardPattern(const QString& pattern = QString());
+    bool match(const QString& text) const;
+
+    bool hasWildcard() const;
+    QString pattern() const;
+    // text before the first and after the last wildcard
+    QString prefix() const;
+    QString suffix() const;
+
+private:
+    bool m_hasWildcard;
+    QString m_pattern;
+    QString m_first;
+    QString m_last;
+    QVector<QString> m_middle;
+};
 
 class WildcardMatcher
 {
@@ -27,20 +52,10 @@ public:
     bool match(const QString& pattern);
 
     static const QChar Wildcard;
+    static const Qt::CaseSensitivity Sensitivity;
 
 private:
-    bool patternEqualsText();
-    bool patternContainsWildcard();
-    bool matchWithWildcards();
-    bool startOrEndDoesNotMatch(const QStringList& parts);
-    bool partsMatch(const QStringList& parts);
-    int getMatchIndex(const QString& part, int startIndex);
-    bool noMatchFound(int index);
-    int calculateNewIndex(int matchIndex, int partLength);
-
-    static const Qt::CaseSensitivity Sensitivity;
     const QString m_text;
-    QString m_pattern;
 };
 
 #endif // KEEPASSX_WILDCARDMATCHER_H
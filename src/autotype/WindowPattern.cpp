@@ -0,0 +1,52 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WindowPattern.h"
+
+WindowPattern::WindowPattern(const QString& pattern)
+    : m_isRegExp(pattern.startsWith("//") && pattern.endsWith("//") && pattern.size() >= 4)
+{
+    if (m_isRegExp) {
+        m_regExp = QRegExp(pattern.mid(2, pattern.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
+    }
+    else {
+        m_wildcard = WildcardPattern(pattern);
+    }
+}
+
+bool WindowPattern::match(const QString& windowTitle) const
+{
+    if (m_isRegExp) {
+        // QRegExp stores the match state so every caller needs its own
+        // copy, it shares the compiled expression with m_regExp
+        QRegExp regExp(m_regExp);
+        return regExp.exactMatch(windowTitle);
+    }
+    else {
+        return m_wildcard.match(windowTitle);
+    }
+}
+
+bool WindowPattern::isRegExp() const
+{
+    return m_isRegExp;
+}
+
+const WildcardPattern& WindowPattern::wildcardPattern() const
+{
+    return m_wildcard;
+}
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_WINDOWPATTERN_H
+#define KEEPASSX_WINDOWPATTERN_H
+
+#include <QRegExp>
+
+#include "autotype/WildcardMatcher.h"
+
+/**
+ * Compiled window title pattern of an auto-type association.
+ *
+ * Patterns enclosed in "//" are regular expressions, all other patterns
+ * are matched with WildcardPattern.
+ */
+class WindowPattern
+{
+public:
+    explicit WindowPattern(const QString& pattern = QString());
+    bool match(const QString& windowTitle) const;
+
+    bool isRegExp() const;
+    const WildcardPattern& wildcardPattern() const;
+
+private:
+    bool m_isRegExp;
+    QRegExp m_regExp;
+    WildcardPattern m_wildcard;
+};
+
+Q_DECLARE_TYPEINFO(WindowPattern, Q_MOVABLE_TYPE);
+
+#endif // KEEPASSX_WINDOWPATTERN_H
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WindowPatternCache.h"
+
+#include "core/AutoTypeAssociations.h"
+
+WindowPatternCache::WindowPatternCache(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void WindowPatternCache::compile(const AutoTypeAssociations* associations)
+{
+    if (m_patterns.contains(associations)) {
+        return;
+    }
+
+    QVector<WindowPattern> patterns;
+    patterns.reserve(associations->size());
+    Q_FOREACH (const AutoTypeAssociations::Association& assoc, associations->getAll()) {
+        patterns.append(WindowPattern(assoc.window));
+    }
+    m_patterns.insert(associations, patterns);
+
+    connect(associations, SIGNAL(modified()), SLOT(invalidate()));
+    connect(associations, SIGNAL(destroyed(QObject*)), SLOT(invalidate(QObject*)));
+}
+
+const QVector<WindowPattern>* WindowPatternCache::patterns(const AutoTypeAssociations* associations) const
+{
+    QHash<const QObject*, QVector<WindowPattern> >::const_iterator i = m_patterns.constFind(associations);
+    if (i == m_patterns.constEnd()) {
+        return Q_NULLPTR;
+    }
+
+    return &i.value();
+}
+
+int WindowPatternCache::count() const
+{
+    return m_patterns.size();
+}
+
+void WindowPatternCache::clear()
+{
+    QHashIterator<const QObject*, QVector<WindowPattern> > i(m_patterns);
+    while (i.hasNext()) {
+        i.next();
+        disconnect(i.key(), Q_NULLPTR, this, Q_NULLPTR);
+    }
+
+    m_patterns.clear();
+}
+
+void WindowPatternCache::invalidate()
+{
+    invalidate(sender());
+}
+
+void WindowPatternCache::invalidate(QObject* associations)
+{
+    m_patterns.remove(associations);
+    disconnect(associations, Q_NULLPTR, this, Q_NULLPTR);
+}
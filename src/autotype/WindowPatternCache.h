@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_WINDOWPATTERNCACHE_H
+#define KEEPASSX_WINDOWPATTERNCACHE_H
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+#include "autotype/WindowPattern.h"
+#include "core/Global.h"
+
+class AutoTypeAssociations;
+
+/**
+ * Compiled window patterns of auto-type associations.
+ *
+ * The patterns of an AutoTypeAssociations object are dropped when it is
+ * modified or deleted.
+ */
+class WindowPatternCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowPatternCache(QObject* parent = Q_NULLPTR);
+
+    /**
+     * Compiles the patterns of associations unless they are cached already.
+     */
+    void compile(const AutoTypeAssociations* associations);
+
+    /**
+     * Returns the patterns in the order of AutoTypeAssociations::getAll()
+     * or Q_NULLPTR if they haven't been compiled. May be called from other
+     * threads while compile() isn't running.
+     */
+    const QVector<WindowPattern>* patterns(const AutoTypeAssociations* associations) const;
+
+    int count() const;
+    void clear();
+
+private Q_SLOTS:
+    void invalidate();
+    void invalidate(QObject* associations);
+
+private:
+    QHash<const QObject*, QVector<WindowPattern> > m_patterns;
+};
+
+#endif // KEEPASSX_WINDOWPATTERNCACHE_H
@@ -16,4 +16,6 @@
 
 #cmakedefine GCRYPT_HAS_SALSA20
 
+#cmakedefine HAVE_AESNI 1
+
 #endif // KEEPASSX_CONFIG_KEEPASSX_H
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AsyncEntrySearcher.h"
+#include "AsyncEntrySearcher_p.h"
+
+#include "core/Database.h"
+#include "core/EntrySearchIndex.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+
+const int AsyncEntrySearcher::BatchSize = 256;
+
+AsyncEntrySearcher::AsyncEntrySearcher(QObject* parent)
+    : QObject(parent)
+    , m_thread(Q_NULLPTR)
+    , m_hasLastResult(false)
+    , m_lastGroup(Q_NULLPTR)
+    , m_lastCaseSensitivity(Qt::CaseSensitive)
+{
+    qRegisterMetaType<QList<Entry*> >("QList<Entry*>");
+}
+
+AsyncEntrySearcher::~AsyncEntrySearcher()
+{
+    // the threads are children of this object and wait for run() to
+    // return when they are deleted
+    cancel();
+}
+
+void AsyncEntrySearcher::search(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity)
+{
+    cancel();
+
+    QStringList words = EntrySearcher::searchWords(searchTerm);
+    QVector<EntrySearchItem> items;
+
+    // the result of an empty term has no fields to search again
+    if (m_hasLastResult && !m_lastWords.isEmpty() && group == m_lastGroup
+            && caseSensitivity == m_lastCaseSensitivity
+            && EntrySearcher::isRefinement(m_lastWords, words, caseSensitivity)) {
+        items = m_lastResult;
+    }
+    else {
+        items = createSnapshot(words, group, caseSensitivity);
+    }
+
+    // the matches become the previous result once the search is complete
+    m_hasLastResult = false;
+    m_lastResult.clear();
+    m_lastWords = words;
+    m_lastGroup = group;
+    m_lastCaseSensitivity = caseSensitivity;
+
+    m_thread = new EntrySearchThread(items, words, caseSensitivity, this);
+    connect(m_thread, SIGNAL(entriesFound(QList<Entry*>)), SLOT(threadEntriesFound(QList<Entry*>)));
+    connect(m_thread, SIGNAL(finished()), SLOT(threadFinished()));
+    m_thread->start();
+}
+
+bool AsyncEntrySearcher::isRunning() const
+{
+    return m_thread != Q_NULLPTR;
+}
+
+void AsyncEntrySearcher::cancel()
+{
+    if (m_thread) {
+        m_thread->cancel();
+        m_thread = Q_NULLPTR;
+    }
+}
+
+void AsyncEntrySearcher::reset()
+{
+    cancel();
+
+    m_hasLastResult = false;
+    m_lastResult.clear();
+    m_lastWords.clear();
+    m_lastGroup = Q_NULLPTR;
+}
+
+void AsyncEntrySearcher::threadEntriesFound(const QList<Entry*>& entries)
+{
+    if (sender() == m_thread) {
+        Q_EMIT entriesFound(entries);
+    }
+}
+
+void AsyncEntrySearcher::threadFinished()
+{
+    EntrySearchThread* thread = static_cast<EntrySearchThread*>(sender());
+
+    if (thread == m_thread) {
+        m_thread = Q_NULLPTR;
+        m_lastResult = thread->result();
+        m_hasLastResult = true;
+
+        Q_EMIT searchFinished();
+    }
+
+    thread->deleteLater();
+}
+
+QVector<EntrySearchItem> AsyncEntrySearcher::createSnapshot(const QStringList& words, const Group* group,
+                                                            Qt::CaseSensitivity caseSensitivity)
+{
+    QVector<EntrySearchItem> snapshot;
+
+    if (!group->resolveSearchingEnabled()) {
+        return snapshot;
+    }
+
+    // every entry matches an empty term
+    bool copyFields = !words.isEmpty();
+
+    const Database* db = group->database();
+    if (db && copyFields) {
+        QSet<Entry*> candidates = db->searchIndex()->search(words, caseSensitivity);
+        if (!candidates.isEmpty()) {
+            addToSnapshot(group, &candidates, copyFields, snapshot);
+        }
+    }
+    else {
+        addToSnapshot(group, Q_NULLPTR, copyFields, snapshot);
+    }
+
+    return snapshot;
+}
+
+void AsyncEntrySearcher::addToSnapshot(const Group* group, const QSet<Entry*>* candidates, bool copyFields,
+                                       QVector<EntrySearchItem>& snapshot)
+{
+    // walk the tree to keep the order of the entries and to skip groups
+    // that have searching disabled
+    Q_FOREACH (Entry* entry, group->entries()) {
+        if (candidates && !candidates->contains(entry)) {
+            continue;
+        }
+
+        EntrySearchItem item;
+        item.entry = entry;
+        if (copyFields) {
+            item.title = entry->title();
+            item.username = entry->username();
+            item.url = entry->url();
+            item.notes = entry->notes();
+        }
+        snapshot.append(item);
+    }
+
+    Q_FOREACH (Group* childGroup, group->children()) {
+        if (candidates && snapshot.size() == candidates->size()) {
+            return;
+        }
+        if (childGroup->searchingEnabled() != Group::Disable) {
+            addToSnapshot(childGroup, candidates, copyFields, snapshot);
+        }
+    }
+}
+
+EntrySearchThread::EntrySearchThread(const QVector<EntrySearchItem>& items, const QStringList& words,
+                                     Qt::CaseSensitivity caseSensitivity, QObject* parent)
+    : QThread(parent)
+    , m_items(items)
+    , m_words(words)
+    , m_caseSensitivity(caseSensitivity)
+    , m_canceled(0)
+{
+}
+
+EntrySearchThread::~EntrySearchThread()
+{
+    cancel();
+    wait();
+}
+
+bool EntrySearchThread::isCanceled() const
+{
+    return m_canceled != 0;
+}
+
+QVector<EntrySearchItem> EntrySearchThread::result() const
+{
+    return m_result;
+}
+
+void EntrySearchThread::cancel()
+{
+    m_canceled = 1;
+}
+
+void EntrySearchThread::run()
+{
+    QList<Entry*> batch;
+
+    // match a few chunks per thread at a time so the first batches arrive
+    // early and a canceled search stops in between
+    int sliceSize = ParallelEntryFilter::MinChunkSize * 4 * qMax(QThread::idealThreadCount(), 1);
+
+    for (int begin = 0; begin < m_items.size() && !isCanceled(); begin += sliceSize) {
+        int end = qMin(begin + sliceSize, m_items.size());
+
+        Q_FOREACH (int index, ParallelEntryFilter::filterIndexes(begin, end, *this)) {
+            const EntrySearchItem& item = m_items.at(index);
+            m_result.append(item);
+            batch.append(item.entry);
+
+            if (batch.size() >= AsyncEntrySearcher::BatchSize) {
+                Q_EMIT entriesFound(batch);
+                batch.clear();
+            }
+        }
+    }
+
+    if (!batch.isEmpty() && !isCanceled()) {
+        Q_EMIT entriesFound(batch);
+    }
+}
+
+bool EntrySearchThread::matches(int index) const
+{
+    if (isCanceled()) {
+        return false;
+    }
+
+    const EntrySearchItem& item = m_items.at(index);
+
+    Q_FOREACH (const QString& word, m_words) {
+        if (!item.title.contains(word, m_caseSensitivity)
+                && !item.username.contains(word, m_caseSensitivity)
+                && !item.url.contains(word, m_caseSensitivity)
+                && !item.notes.contains(word, m_caseSensitivity)) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ASYNCENTRYSEARCHER_H
+#define KEEPASSX_ASYNCENTRYSEARCHER_H
+
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include "core/Global.h"
+
+class Entry;
+class EntrySearchThread;
+class Group;
+struct EntrySearchItem;
+
+/**
+ * Searches entries on a background thread.
+ *
+ * Groups of a database are searched through the search index of the
+ * database on the calling thread, only the searchable fields of the
+ * candidates are copied into a snapshot for the worker, so it never
+ * touches Entry objects. Groups without a database are snapshotted
+ * completely. The worker matches the snapshot in chunks on the global
+ * thread pool (see ParallelEntryFilter). Matches are reported in batches
+ * through entriesFound(), in tree order. Starting a new search cancels the
+ * running one; batches of canceled searches are dropped.
+ *
+ * If the new search term narrows down the term of the previous completed
+ * search (see EntrySearcher::isRefinement()) and the group and case
+ * sensitivity are unchanged, only the previous matches are searched again.
+ *
+ * reset() has to be called when entries or groups have been modified as
+ * the previous matches are reused until then.
+ */
+class AsyncEntrySearcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncEntrySearcher(QObject* parent = Q_NULLPTR);
+    ~AsyncEntrySearcher();
+    void search(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity);
+    bool isRunning() const;
+
+    static const int BatchSize;
+
+public Q_SLOTS:
+    void cancel();
+    void reset();
+
+Q_SIGNALS:
+    void entriesFound(const QList<Entry*>& entries);
+    void searchFinished();
+
+private Q_SLOTS:
+    void threadEntriesFound(const QList<Entry*>& entries);
+    void threadFinished();
+
+private:
+    QVector<EntrySearchItem> createSnapshot(const QStringList& words, const Group* group,
+                                            Qt::CaseSensitivity caseSensitivity);
+    void addToSnapshot(const Group* group, const QSet<Entry*>* candidates, bool copyFields,
+                       QVector<EntrySearchItem>& snapshot);
+
+    EntrySearchThread* m_thread;
+
+    bool m_hasLastResult;
+    QVector<EntrySearchItem> m_lastResult;
+    QStringList m_lastWords;
+    const Group* m_lastGroup;
+    Qt::CaseSensitivity m_lastCaseSensitivity;
+
+    Q_DISABLE_COPY(AsyncEntrySearcher)
+};
+
+#endif // KEEPASSX_ASYNCENTRYSEARCHER_H
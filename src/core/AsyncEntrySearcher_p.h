@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ASYNCENTRYSEARCHER_P_H
+#define KEEPASSX_ASYNCENTRYSEARCHER_P_H
+
+#include <QAtomicInt>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+#include "core/Global.h"
+#include "core/ParallelEntryFilter.h"
+
+class Entry;
+
+struct EntrySearchItem
+{
+    Entry* entry;
+    QString title;
+    QString username;
+    QString url;
+    QString notes;
+};
+
+Q_DECLARE_TYPEINFO(EntrySearchItem, Q_MOVABLE_TYPE);
+
+class EntrySearchThread : public QThread, private IndexMatcher
+{
+    Q_OBJECT
+
+public:
+    EntrySearchThread(const QVector<EntrySearchItem>& items, const QStringList& words,
+                      Qt::CaseSensitivity caseSensitivity, QObject* parent = Q_NULLPTR);
+    ~EntrySearchThread();
+    bool isCanceled() const;
+    QVector<EntrySearchItem> result() const;
+
+public Q_SLOTS:
+    void cancel();
+
+Q_SIGNALS:
+    void entriesFound(const QList<Entry*>& entries);
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    bool matches(int index) const Q_DECL_OVERRIDE;
+
+    const QVector<EntrySearchItem> m_items;
+    const QStringList m_words;
+    const Qt::CaseSensitivity m_caseSensitivity;
+    QVector<EntrySearchItem> m_result;
+    QAtomicInt m_canceled;
+
+    Q_DISABLE_COPY(EntrySearchThread)
+};
+
+#endif // KEEPASSX_ASYNCENTRYSEARCHER_P_H
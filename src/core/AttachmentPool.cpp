@@ -0,0 +1,124 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AttachmentPool.h"
+
+#include <QMutexLocker>
+
+AttachmentPool::AttachmentPool()
+    : m_nextKey(0)
+{
+}
+
+int AttachmentPool::add(const QByteArray& data)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<QByteArray, int>::const_iterator i = m_keys.constFind(data);
+    if (i != m_keys.constEnd()) {
+        m_items[i.value()].refCount++;
+        return i.value();
+    }
+
+    int key = m_nextKey++;
+
+    Item item;
+    item.data = data;
+    item.refCount = 1;
+    m_items.insert(key, item);
+    m_keys.insert(data, key);
+
+    return key;
+}
+
+void AttachmentPool::ref(int key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<int, Item>::iterator i = m_items.find(key);
+    Q_ASSERT(i != m_items.end());
+
+    if (i != m_items.end()) {
+        i.value().refCount++;
+    }
+}
+
+void AttachmentPool::release(int key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<int, Item>::iterator i = m_items.find(key);
+    Q_ASSERT(i != m_items.end());
+
+    if (i != m_items.end()) {
+        i.value().refCount--;
+
+        if (i.value().refCount == 0) {
+            m_keys.remove(i.value().data);
+            m_items.erase(i);
+        }
+    }
+}
+
+QByteArray AttachmentPool::data(int key) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_items.value(key).data;
+}
+
+int AttachmentPool::dataSize(int key) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<int, Item>::const_iterator i = m_items.constFind(key);
+
+    if (i != m_items.constEnd()) {
+        return i.value().data.size();
+    }
+    else {
+        return 0;
+    }
+}
+
+int AttachmentPool::refCount(int key) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<int, Item>::const_iterator i = m_items.constFind(key);
+
+    if (i != m_items.constEnd()) {
+        return i.value().refCount;
+    }
+    else {
+        return 0;
+    }
+}
+
+int AttachmentPool::count() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_items.size();
+}
+
+AttachmentPool* AttachmentPool::instance()
+{
+    // not heap allocated so the remaining items are freed on exit
+    static AttachmentPool pool;
+    return &pool;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ATTACHMENTPOOL_H
+#define KEEPASSX_ATTACHMENTPOOL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+#include "core/Global.h"
+
+/**
+ * Content-addressed store for attachment data.
+ *
+ * Identical attachments of all entries and history items share one
+ * reference counted item, EntryAttachments only holds the keys.
+ * Items are dropped once the last reference is released.
+ *
+ * The pool is shared by all databases and by entries that don't belong to
+ * one, all methods lock so entries may be created or destroyed in worker
+ * threads. The instance lives until the application exits.
+ */
+class AttachmentPool
+{
+public:
+    int add(const QByteArray& data);
+    void ref(int key);
+    void release(int key);
+    QByteArray data(int key) const;
+    int dataSize(int key) const;
+    int refCount(int key) const;
+    int count() const;
+
+    static AttachmentPool* instance();
+
+private:
+    struct Item
+    {
+        QByteArray data;
+        int refCount;
+    };
+
+    AttachmentPool();
+
+    mutable QMutex m_mutex;
+    QHash<int, Item> m_items;
+    QHash<QByteArray, int> m_keys;
+    int m_nextKey;
+
+    Q_DISABLE_COPY(AttachmentPool)
+};
+
+inline AttachmentPool* attachmentPool() {
+    return AttachmentPool::instance();
+}
+
+#endif // KEEPASSX_ATTACHMENTPOOL_H
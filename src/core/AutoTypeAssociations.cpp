@@ -66,13 +66,21 @@ void AutoTypeAssociations::remove(int index)
 
 void AutoTypeAssociations::removeEmpty()
 {
-    QMutableListIterator<AutoTypeAssociations::Association> i(m_associations);
-    while (i.hasNext()) {
-        const Association& assoc = i.next();
-        if (assoc.window.isEmpty() && assoc.sequence.isEmpty()) {
-            i.remove();
+    QList<AutoTypeAssociations::Association> associations;
+    Q_FOREACH (const Association& assoc, m_associations) {
+        if (!assoc.window.isEmpty() || !assoc.sequence.isEmpty()) {
+            associations.append(assoc);
         }
     }
+
+    if (associations.size() == m_associations.size()) {
+        return;
+    }
+
+    Q_EMIT aboutToReset();
+    m_associations = associations;
+    Q_EMIT reset();
+    Q_EMIT modified();
 }
 
 void AutoTypeAssociations::update(int index, const AutoTypeAssociations::Association& association)
@@ -105,5 +113,12 @@ int AutoTypeAssociations::size() const
 
 void AutoTypeAssociations::clear()
 {
+    if (m_associations.isEmpty()) {
+        return;
+    }
+
+    Q_EMIT aboutToReset();
     m_associations.clear();
+    Q_EMIT reset();
+    Q_EMIT modified();
 }
@@ -48,6 +48,9 @@ public:
     void clear();
 
 private:
+    // history snapshots copy the data without the signals
+    friend class Entry;
+
     QList<AutoTypeAssociations::Association> m_associations;
 
 Q_SIGNALS:
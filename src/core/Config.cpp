@@ -100,6 +100,8 @@ void Config::init(const QString& fileName)
     m_defaults.insert("security/clearclipboardtimeout", 10);
     m_defaults.insert("security/lockdatabaseidle", false);
     m_defaults.insert("security/lockdatabaseidlesec", 10);
+    m_defaults.insert("security/cachetransformedkeys", false);
+    m_defaults.insert("security/cachetransformedkeyssec", 600);
     m_defaults.insert("security/passwordscleartext", false);
     m_defaults.insert("security/autotypeask", true);
     m_defaults.insert("GUI/Language", "system");
@@ -21,18 +21,23 @@
 #include <QTimer>
 #include <QXmlStreamReader>
 
+#include "core/EntrySearchIndex.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/Random.h"
 #include "format/KeePass2.h"
+#include "keys/TransformedKeyCache.h"
 
 QHash<Uuid, Database*> Database::m_uuidMap;
 
 Database::Database()
     : m_metadata(new Metadata(this))
+    , m_searchIndex(new EntrySearchIndex(this))
     , m_timer(new QTimer(this))
     , m_emitModified(false)
+    , m_batchUpdateDepth(0)
+    , m_modifiedDuringBatch(false)
     , m_uuid(Uuid::random())
 {
     m_data.cipher = KeePass2::CIPHER_AES;
@@ -46,7 +51,7 @@ Database::Database()
 
     m_uuidMap.insert(m_uuid, this);
 
-    connect(m_metadata, SIGNAL(modified()), this, SIGNAL(modifiedImmediate()));
+    connect(m_metadata, SIGNAL(modified()), this, SLOT(emitModifiedImmediate()));
     connect(m_metadata, SIGNAL(nameTextChanged()), this, SIGNAL(nameTextChanged()));
     connect(this, SIGNAL(modifiedImmediate()), this, SLOT(startModifiedTimer()));
     connect(m_timer, SIGNAL(timeout()), SIGNAL(modified()));
@@ -54,6 +59,15 @@ Database::Database()
 
 Database::~Database()
 {
+    // delete the groups (including root groups that have been replaced
+    // but not deleted yet) while the uuid index still exists
+    Q_FOREACH (QObject* child, children()) {
+        Group* group = qobject_cast<Group*>(child);
+        if (group) {
+            delete group;
+        }
+    }
+
     m_uuidMap.remove(m_uuid);
 }
 
@@ -87,46 +101,39 @@ const Metadata* Database::metadata() const
 
 Entry* Database::resolveEntry(const Uuid& uuid)
 {
-    return recFindEntry(uuid, m_rootGroup);
+    return m_entryIndex.value(uuid);
 }
 
-Entry* Database::recFindEntry(const Uuid& uuid, Group* group)
+Group* Database::resolveGroup(const Uuid& uuid)
 {
-    Q_FOREACH (Entry* entry, group->entries()) {
-        if (entry->uuid() == uuid) {
-            return entry;
-        }
-    }
-
-    Q_FOREACH (Group* child, group->children()) {
-        Entry* result = recFindEntry(uuid, child);
-        if (result) {
-            return result;
-        }
-    }
+    return m_groupIndex.value(uuid);
+}
 
-    return Q_NULLPTR;
+EntrySearchIndex* Database::searchIndex() const
+{
+    return m_searchIndex;
 }
 
-Group* Database::resolveGroup(const Uuid& uuid)
+void Database::addToIndex(Entry* entry)
 {
-    return recFindGroup(uuid, m_rootGroup);
+    m_entryIndex.insert(entry->uuid(), entry);
+    m_searchIndex->addEntry(entry);
 }
 
-Group* Database::recFindGroup(const Uuid& uuid, Group* group)
+void Database::removeFromIndex(const Uuid& uuid, Entry* entry)
 {
-    if (group->uuid() == uuid) {
-        return group;
-    }
+    m_entryIndex.remove(uuid, entry);
+    m_searchIndex->removeEntry(entry);
+}
 
-    Q_FOREACH (Group* child, group->children()) {
-        Group* result = recFindGroup(uuid, child);
-        if (result) {
-            return result;
-        }
-    }
+void Database::addToIndex(Group* group)
+{
+    m_groupIndex.insert(group->uuid(), group);
+}
 
-    return Q_NULLPTR;
+void Database::removeFromIndex(const Uuid& uuid, Group* group)
+{
+    m_groupIndex.remove(uuid, group);
 }
 
 QList<DeletedObject> Database::deletedObjects()
@@ -211,15 +218,29 @@ void Database::setTransformRounds(quint64 rounds)
 }
 
 void Database::setKey(const CompositeKey& key, const QByteArray& transformSeed, bool updateChangedTime)
+{
+    QByteArray transformedMasterKey = transformedKeyCache()->transformedKey(key, transformSeed,
+                                                                          transformRounds());
+    if (transformedMasterKey.isEmpty()) {
+        transformedMasterKey = key.transform(transformSeed, transformRounds());
+    }
+
+    setKey(key, transformSeed, transformRounds(), transformedMasterKey, updateChangedTime);
+}
+
+void Database::setKey(const CompositeKey& key, const QByteArray& transformSeed, quint64 transformRounds,
+                      const QByteArray& transformedMasterKey, bool updateChangedTime)
 {
     m_data.key = key;
     m_data.transformSeed = transformSeed;
-    m_data.transformedMasterKey = key.transform(transformSeed, transformRounds());
+    m_data.transformRounds = transformRounds;
+    m_data.transformedMasterKey = transformedMasterKey;
+    transformedKeyCache()->insert(key, transformSeed, transformRounds, transformedMasterKey);
     m_data.hasKey = true;
     if (updateChangedTime) {
         m_metadata->setMasterKeyChanged(Tools::currentDateTimeUtc());
     }
-    Q_EMIT modifiedImmediate();
+    emitModifiedImmediate();
 }
 
 void Database::setKey(const CompositeKey& key)
@@ -227,6 +248,11 @@ void Database::setKey(const CompositeKey& key)
     setKey(key, randomGen()->randomArray(32));
 }
 
+CompositeKey Database::key() const
+{
+    return m_data.key;
+}
+
 bool Database::hasKey() const
 {
     return m_data.hasKey;
@@ -297,6 +323,37 @@ void Database::setEmitModified(bool value)
     m_emitModified = value;
 }
 
+void Database::beginBatchUpdate()
+{
+    m_batchUpdateDepth++;
+
+    if (m_batchUpdateDepth == 1) {
+        m_modifiedDuringBatch = false;
+        Q_EMIT batchUpdateStarted();
+    }
+}
+
+void Database::endBatchUpdate()
+{
+    Q_ASSERT(m_batchUpdateDepth > 0);
+
+    m_batchUpdateDepth--;
+
+    if (m_batchUpdateDepth == 0) {
+        Q_EMIT batchUpdateFinished();
+
+        if (m_modifiedDuringBatch) {
+            m_modifiedDuringBatch = false;
+            Q_EMIT modifiedImmediate();
+        }
+    }
+}
+
+bool Database::isBatchUpdating() const
+{
+    return m_batchUpdateDepth > 0;
+}
+
 void Database::copyAttributesFrom(const Database* other)
 {
     m_data = other->m_data;
@@ -324,3 +381,13 @@ void Database::startModifiedTimer()
     }
     m_timer->start(150);
 }
+
+void Database::emitModifiedImmediate()
+{
+    if (m_batchUpdateDepth > 0) {
+        m_modifiedDuringBatch = true;
+    }
+    else {
+        Q_EMIT modifiedImmediate();
+    }
+}
@@ -25,6 +25,7 @@
 #include "keys/CompositeKey.h"
 
 class Entry;
+class EntrySearchIndex;
 class Group;
 class Metadata;
 class QTimer;
@@ -80,6 +81,13 @@ public:
     const Metadata* metadata() const;
     Entry* resolveEntry(const Uuid& uuid);
     Group* resolveGroup(const Uuid& uuid);
+
+    /**
+     * Returns the search index of the entries in this database.
+     * The index is built on the first search and updated on demand
+     * afterwards, so it's returned even for const databases.
+     */
+    EntrySearchIndex* searchIndex() const;
     QList<DeletedObject> deletedObjects();
     void addDeletedObject(const DeletedObject& delObj);
     void addDeletedObject(const Uuid& uuid);
@@ -97,15 +105,33 @@ public:
     void setTransformRounds(quint64 rounds);
     void setKey(const CompositeKey& key, const QByteArray& transformSeed, bool updateChangedTime = true);
 
+    /**
+     * Sets the database key from a transformed key that has already been
+     * computed with transformSeed and transformRounds, e.g. by KeyTransformer.
+     */
+    void setKey(const CompositeKey& key, const QByteArray& transformSeed, quint64 transformRounds,
+                const QByteArray& transformedMasterKey, bool updateChangedTime = true);
+
     /**
      * Sets the database key and generates a random transform seed.
      */
     void setKey(const CompositeKey& key);
+    CompositeKey key() const;
     bool hasKey() const;
     bool verifyKey(const CompositeKey& key) const;
     void recycleEntry(Entry* entry);
     void recycleGroup(Group* group);
     void setEmitModified(bool value);
+
+    /**
+     * Call before and after changing many entries or groups at once.
+     * modifiedImmediate() is emitted only once when the outermost
+     * endBatchUpdate() is reached, and models reset themselves once
+     * instead of updating row by row. Calls can be nested.
+     */
+    void beginBatchUpdate();
+    void endBatchUpdate();
+    bool isBatchUpdating() const;
     void copyAttributesFrom(const Database* other);
 
     /**
@@ -123,25 +149,50 @@ Q_SIGNALS:
     void groupRemoved();
     void groupAboutToMove(Group* group, Group* toGroup, int index);
     void groupMoved();
+
+    /**
+     * Forwarded from the groups of this database, so entry changes can be
+     * followed without connecting to every group.
+     */
+    void entryAboutToAdd(Entry* entry);
+    void entryAdded(Entry* entry);
+    void entryAboutToRemove(Entry* entry);
+    void entryRemoved(Entry* entry);
+    void entryDataChanged(Entry* entry);
+
     void nameTextChanged();
     void modified();
     void modifiedImmediate();
+    void batchUpdateStarted();
+    void batchUpdateFinished();
 
 private Q_SLOTS:
     void startModifiedTimer();
+    void emitModifiedImmediate();
 
 private:
-    Entry* recFindEntry(const Uuid& uuid, Group* group);
-    Group* recFindGroup(const Uuid& uuid, Group* group);
+    // Group and Entry keep the uuid index up to date
+    friend class Entry;
+    friend class Group;
+
+    void addToIndex(Entry* entry);
+    void removeFromIndex(const Uuid& uuid, Entry* entry);
+    void addToIndex(Group* group);
+    void removeFromIndex(const Uuid& uuid, Group* group);
 
     void createRecycleBin();
 
     Metadata* const m_metadata;
+    EntrySearchIndex* const m_searchIndex;
     Group* m_rootGroup;
     QList<DeletedObject> m_deletedObjects;
     QTimer* m_timer;
     DatabaseData m_data;
     bool m_emitModified;
+    int m_batchUpdateDepth;
+    bool m_modifiedDuringBatch;
+    QMultiHash<Uuid, Entry*> m_entryIndex;
+    QMultiHash<Uuid, Group*> m_groupIndex;
 
     Uuid m_uuid;
     static QHash<Uuid, Database*> m_uuidMap;
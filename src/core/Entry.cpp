@@ -17,6 +17,7 @@
 
 #include "Entry.h"
 
+#include "core/AttachmentPool.h"
 #include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Group.h"
@@ -25,11 +26,50 @@
 
 const int Entry::DefaultIconNumber = 0;
 
+namespace {
+
+// shared by the const accessors of all entries that don't have any
+// attachments or auto-type associations yet
+const EntryAttachments* emptyAttachments()
+{
+    static const EntryAttachments instance;
+    return &instance;
+}
+
+const AutoTypeAssociations* emptyAutoTypeAssociations()
+{
+    static const AutoTypeAssociations instance;
+    return &instance;
+}
+
+int attributesSize(const QMap<QString, QString>& attributes)
+{
+    int size = 0;
+
+    QMapIterator<QString, QString> i(attributes);
+    while (i.hasNext()) {
+        i.next();
+        size += i.value().toUtf8().size();
+    }
+    return size;
+}
+
+void resetTimeInfo(TimeInfo& timeInfo)
+{
+    QDateTime now = Tools::currentDateTimeUtc();
+    timeInfo.setCreationTime(now);
+    timeInfo.setLastModificationTime(now);
+    timeInfo.setLastAccessTime(now);
+    timeInfo.setLocationChanged(now);
+}
+
+}
+
 Entry::Entry()
     : m_attributes(new EntryAttributes(this))
-    , m_attachments(new EntryAttachments(this))
-    , m_autoTypeAssociations(new AutoTypeAssociations(this))
-    , m_tmpHistoryItem(Q_NULLPTR)
+    , m_attachments(Q_NULLPTR)
+    , m_autoTypeAssociations(Q_NULLPTR)
+    , m_updating(false)
     , m_modifiedSinceBegin(false)
     , m_updateTimeinfo(true)
 {
@@ -37,13 +77,8 @@ Entry::Entry()
     m_data.autoTypeEnabled = true;
     m_data.autoTypeObfuscation = 0;
 
-    connect(m_attributes, SIGNAL(modified()), this, SIGNAL(modified()));
+    connect(m_attributes, SIGNAL(modified()), SLOT(emitModified()));
     connect(m_attributes, SIGNAL(defaultKeyModified()), SLOT(emitDataChanged()));
-    connect(m_attachments, SIGNAL(modified()), this, SIGNAL(modified()));
-    connect(m_autoTypeAssociations, SIGNAL(modified()), SIGNAL(modified()));
-
-    connect(this, SIGNAL(modified()), SLOT(updateTimeinfo()));
-    connect(this, SIGNAL(modified()), SLOT(updateModifiedSinceBegin()));
 }
 
 Entry::~Entry()
@@ -56,14 +91,21 @@ Entry::~Entry()
         }
     }
 
-    qDeleteAll(m_history);
+    Q_FOREACH (const EntrySnapshot& item, m_history) {
+        releaseAttachments(item);
+    }
+    qDeleteAll(m_historyEntries);
+
+    if (m_updating) {
+        releaseAttachments(m_tmpHistoryItem);
+    }
 }
 
 template <class T> inline bool Entry::set(T& property, const T& value)
 {
     if (property != value) {
         property = value;
-        Q_EMIT modified();
+        emitModified();
         return true;
     }
     else {
@@ -176,12 +218,22 @@ QString Entry::defaultAutoTypeSequence() const
 
 AutoTypeAssociations* Entry::autoTypeAssociations()
 {
+    if (!m_autoTypeAssociations) {
+        m_autoTypeAssociations = new AutoTypeAssociations(this);
+        connect(m_autoTypeAssociations, SIGNAL(modified()), SLOT(emitModified()));
+    }
+
     return m_autoTypeAssociations;
 }
 
 const AutoTypeAssociations* Entry::autoTypeAssociations() const
 {
-    return m_autoTypeAssociations;
+    if (m_autoTypeAssociations) {
+        return m_autoTypeAssociations;
+    }
+    else {
+        return emptyAutoTypeAssociations();
+    }
 }
 
 QString Entry::title() const
@@ -226,18 +278,33 @@ const EntryAttributes* Entry::attributes() const
 
 EntryAttachments* Entry::attachments()
 {
+    if (!m_attachments) {
+        m_attachments = new EntryAttachments(this);
+        connect(m_attachments, SIGNAL(modified()), SLOT(emitModified()));
+    }
+
     return m_attachments;
 }
 
 const EntryAttachments* Entry::attachments() const
 {
-    return m_attachments;
+    if (m_attachments) {
+        return m_attachments;
+    }
+    else {
+        return emptyAttachments();
+    }
 }
 
 void Entry::setUuid(const Uuid& uuid)
 {
     Q_ASSERT(!uuid.isNull());
-    set(m_uuid, uuid);
+
+    Uuid oldUuid = m_uuid;
+    if (set(m_uuid, uuid) && m_group && m_group->database()) {
+        m_group->database()->removeFromIndex(oldUuid, this);
+        m_group->database()->addToIndex(this);
+    }
 }
 
 void Entry::setIcon(int iconNumber)
@@ -250,7 +317,7 @@ void Entry::setIcon(int iconNumber)
 
         m_pixmapCacheKey = QPixmapCache::Key();
 
-        Q_EMIT modified();
+        emitModified();
         emitDataChanged();
     }
 }
@@ -265,7 +332,7 @@ void Entry::setIcon(const Uuid& uuid)
 
         m_pixmapCacheKey = QPixmapCache::Key();
 
-        Q_EMIT modified();
+        emitModified();
         emitDataChanged();
     }
 }
@@ -339,7 +406,8 @@ void Entry::setExpires(const bool& value)
 {
     if (m_data.timeInfo.expires() != value) {
         m_data.timeInfo.setExpires(value);
-        Q_EMIT modified();
+        emitModified();
+        emitDataChanged();
     }
 }
 
@@ -347,16 +415,42 @@ void Entry::setExpiryTime(const QDateTime& dateTime)
 {
     if (m_data.timeInfo.expiryTime() != dateTime) {
         m_data.timeInfo.setExpiryTime(dateTime);
-        Q_EMIT modified();
+        emitModified();
+        emitDataChanged();
     }
 }
 
 QList<Entry*> Entry::historyItems()
 {
-    return m_history;
+    const Entry* constThis = this;
+    return constThis->historyItems();
 }
 
 const QList<Entry*>& Entry::historyItems() const
+{
+    for (int i = 0; i < m_history.size(); i++) {
+        historyItem(i);
+    }
+
+    return m_historyEntries;
+}
+
+Entry* Entry::historyItem(int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_history.size());
+
+    while (m_historyEntries.size() < m_history.size()) {
+        m_historyEntries.append(Q_NULLPTR);
+    }
+
+    if (!m_historyEntries.at(index)) {
+        m_historyEntries[index] = fromSnapshot(m_history.at(index));
+    }
+
+    return m_historyEntries.at(index);
+}
+
+const QList<EntrySnapshot>& Entry::historySnapshots() const
 {
     return m_history;
 }
@@ -366,8 +460,25 @@ void Entry::addHistoryItem(Entry* entry)
     Q_ASSERT(!entry->parent());
     Q_ASSERT(entry->uuid() == uuid());
 
-    m_history.append(entry);
-    Q_EMIT modified();
+    // keep the object itself so the caller's pointer stays valid
+    while (m_historyEntries.size() < m_history.size()) {
+        m_historyEntries.append(Q_NULLPTR);
+    }
+
+    EntrySnapshot item = entry->snapshot();
+    refAttachments(item);
+    m_history.append(item);
+    m_historyEntries.append(entry);
+
+    emitModified();
+}
+
+void Entry::addHistoryItem(const EntrySnapshot& snapshot)
+{
+    Q_ASSERT(snapshot.uuid == uuid());
+
+    appendHistory(snapshot);
+    emitModified();
 }
 
 void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
@@ -379,13 +490,15 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
     Q_FOREACH (Entry* entry, historyEntries) {
         Q_ASSERT(!entry->parent());
         Q_ASSERT(entry->uuid() == uuid());
-        Q_ASSERT(m_history.contains(entry));
+        Q_ASSERT(m_historyEntries.contains(entry));
 
-        m_history.removeOne(entry);
-        delete entry;
+        int index = m_historyEntries.indexOf(entry);
+        if (index != -1) {
+            removeHistory(index);
+        }
     }
 
-    Q_EMIT modified();
+    emitModified();
 }
 
 void Entry::truncateHistory()
@@ -398,48 +511,130 @@ void Entry::truncateHistory()
 
     int histMaxItems = db->metadata()->historyMaxItems();
     if (histMaxItems > -1) {
-        int historyCount = 0;
-        QMutableListIterator<Entry*> i(m_history);
-        i.toBack();
-        while (i.hasPrevious()) {
-            historyCount++;
-            Entry* entry = i.previous();
-            if (historyCount > histMaxItems) {
-                delete entry;
-                i.remove();
-            }
+        while (m_history.size() > histMaxItems) {
+            removeHistory(0);
         }
     }
 
     int histMaxSize = db->metadata()->historyMaxSize();
     if (histMaxSize > -1) {
         int size = 0;
-        QSet<QByteArray> foundAttachements = attachments()->values().toSet();
+        // attachments are identified by their pool key so each distinct
+        // attachment is only counted once without comparing the data
+        const Entry* constThis = this;
+        QSet<int> foundAttachements = constThis->attachments()->poolKeys().toSet();
 
-        QMutableListIterator<Entry*> i(m_history);
-        i.toBack();
-        while (i.hasPrevious()) {
-            Entry* historyItem = i.previous();
+        for (int i = m_history.size() - 1; i >= 0; i--) {
+            const EntrySnapshot& historyItem = m_history.at(i);
 
             // don't calculate size if it's already above the maximum
             if (size <= histMaxSize) {
-                size += historyItem->attributes()->attributesSize();
+                size += attributesSize(historyItem.attributes);
 
-                QSet<QByteArray> newAttachments = historyItem->attachments()->values().toSet() - foundAttachements;
-                Q_FOREACH (const QByteArray& attachment, newAttachments) {
-                    size += attachment.size();
+                Q_FOREACH (int poolKey, historyItem.attachments) {
+                    if (!foundAttachements.contains(poolKey)) {
+                        size += attachmentPool()->dataSize(poolKey);
+                        foundAttachements.insert(poolKey);
+                    }
                 }
-                foundAttachements += newAttachments;
             }
 
             if (size > histMaxSize) {
-                delete historyItem;
-                i.remove();
+                removeHistory(i);
             }
         }
     }
 }
 
+void Entry::resetHistoryIcon(const Uuid& uuid)
+{
+    for (int i = 0; i < m_history.size(); i++) {
+        EntryData& data = m_history[i].data;
+        if (data.customIcon != uuid) {
+            continue;
+        }
+
+        data.iconNumber = DefaultIconNumber;
+        data.customIcon = Uuid();
+
+        Entry* entry = m_historyEntries.value(i);
+        if (entry) {
+            entry->setUpdateTimeinfo(false);
+            entry->setIcon(DefaultIconNumber);
+            entry->setUpdateTimeinfo(true);
+        }
+    }
+}
+
+EntrySnapshot Entry::snapshot() const
+{
+    EntrySnapshot snapshot;
+    snapshot.uuid = m_uuid;
+    snapshot.data = m_data;
+    snapshot.attributes = m_attributes->m_attributes;
+    snapshot.protectedAttributes = m_attributes->m_protectedAttributes;
+    if (m_attachments) {
+        snapshot.attachments = m_attachments->m_attachments;
+    }
+    if (m_autoTypeAssociations) {
+        snapshot.autoTypeAssociations = m_autoTypeAssociations->m_associations;
+    }
+
+    return snapshot;
+}
+
+Entry* Entry::fromSnapshot(const EntrySnapshot& snapshot)
+{
+    Entry* entry = new Entry();
+    entry->m_uuid = snapshot.uuid;
+    entry->m_data = snapshot.data;
+    entry->m_attributes->m_attributes = snapshot.attributes;
+    entry->m_attributes->m_protectedAttributes = snapshot.protectedAttributes;
+    if (!snapshot.attachments.isEmpty()) {
+        refAttachments(snapshot);
+        entry->attachments()->m_attachments = snapshot.attachments;
+    }
+    if (!snapshot.autoTypeAssociations.isEmpty()) {
+        entry->autoTypeAssociations()->m_associations = snapshot.autoTypeAssociations;
+    }
+
+    return entry;
+}
+
+void Entry::appendHistory(const EntrySnapshot& snapshot)
+{
+    refAttachments(snapshot);
+    m_history.append(snapshot);
+
+    if (!m_historyEntries.isEmpty()) {
+        m_historyEntries.append(Q_NULLPTR);
+    }
+}
+
+void Entry::removeHistory(int index)
+{
+    releaseAttachments(m_history.at(index));
+    m_history.removeAt(index);
+
+    if (!m_historyEntries.isEmpty()) {
+        delete m_historyEntries.takeAt(index);
+    }
+}
+
+void Entry::refAttachments(const EntrySnapshot& snapshot)
+{
+    Q_FOREACH (int poolKey, snapshot.attachments) {
+        attachmentPool()->ref(poolKey);
+    }
+}
+
+void Entry::releaseAttachments(const EntrySnapshot& snapshot)
+{
+    Q_FOREACH (int poolKey, snapshot.attachments) {
+        attachmentPool()->release(poolKey);
+    }
+}
+
 Entry* Entry::clone(CloneFlags flags) const
 {
     Entry* entry = new Entry();
@@ -452,29 +647,27 @@ Entry* Entry::clone(CloneFlags flags) const
     }
     entry->m_data = m_data;
     entry->m_attributes->copyDataFrom(m_attributes);
-    entry->m_attachments->copyDataFrom(m_attachments);
-    entry->m_autoTypeAssociations->copyDataFrom(this->m_autoTypeAssociations);
+    if (m_attachments) {
+        entry->attachments()->copyDataFrom(m_attachments);
+    }
+    if (m_autoTypeAssociations) {
+        entry->autoTypeAssociations()->copyDataFrom(m_autoTypeAssociations);
+    }
     if (flags & CloneIncludeHistory) {
-        Q_FOREACH (Entry* historyItem, m_history) {
-            Entry* historyItemClone = historyItem->clone(flags & ~CloneIncludeHistory & ~CloneNewUuid);
-            historyItemClone->setUpdateTimeinfo(false);
-            historyItemClone->setUuid(entry->uuid());
-            historyItemClone->setUpdateTimeinfo(true);
-            entry->addHistoryItem(historyItemClone);
+        Q_FOREACH (EntrySnapshot historyItem, m_history) {
+            historyItem.uuid = entry->m_uuid;
+            if (flags & CloneResetTimeInfo) {
+                resetTimeInfo(historyItem.data.timeInfo);
+            }
+            entry->appendHistory(historyItem);
         }
     }
     entry->setUpdateTimeinfo(true);
 
     if (flags & CloneResetTimeInfo) {
-        QDateTime now = Tools::currentDateTimeUtc();
-        entry->m_data.timeInfo.setCreationTime(now);
-        entry->m_data.timeInfo.setLastModificationTime(now);
-        entry->m_data.timeInfo.setLastAccessTime(now);
-        entry->m_data.timeInfo.setLocationChanged(now);
+        resetTimeInfo(entry->m_data.timeInfo);
     }
 
-
-
     return entry;
 }
 
@@ -483,43 +676,53 @@ void Entry::copyDataFrom(const Entry* other)
     setUpdateTimeinfo(false);
     m_data = other->m_data;
     m_attributes->copyDataFrom(other->m_attributes);
-    m_attachments->copyDataFrom(other->m_attachments);
-    m_autoTypeAssociations->copyDataFrom(other->m_autoTypeAssociations);
+    if (m_attachments || other->m_attachments) {
+        attachments()->copyDataFrom(other->attachments());
+    }
+    if (m_autoTypeAssociations || other->m_autoTypeAssociations) {
+        autoTypeAssociations()->copyDataFrom(other->autoTypeAssociations());
+    }
     setUpdateTimeinfo(true);
+
+    emitDataChanged();
 }
 
 void Entry::beginUpdate()
 {
-    Q_ASSERT(!m_tmpHistoryItem);
+    Q_ASSERT(!m_updating);
 
-    m_tmpHistoryItem = new Entry();
-    m_tmpHistoryItem->setUpdateTimeinfo(false);
-    m_tmpHistoryItem->m_uuid = m_uuid;
-    m_tmpHistoryItem->m_data = m_data;
-    m_tmpHistoryItem->m_attributes->copyDataFrom(m_attributes);
-    m_tmpHistoryItem->m_attachments->copyDataFrom(m_attachments);
+    m_tmpHistoryItem = snapshot();
+    refAttachments(m_tmpHistoryItem);
+    m_updating = true;
 
     m_modifiedSinceBegin = false;
 }
 
 void Entry::endUpdate()
 {
-    Q_ASSERT(m_tmpHistoryItem);
+    Q_ASSERT(m_updating);
     if (m_modifiedSinceBegin) {
-        m_tmpHistoryItem->setUpdateTimeinfo(true);
         addHistoryItem(m_tmpHistoryItem);
         truncateHistory();
     }
-    else {
-        delete m_tmpHistoryItem;
-    }
 
-    m_tmpHistoryItem = Q_NULLPTR;
+    releaseAttachments(m_tmpHistoryItem);
+    m_tmpHistoryItem = EntrySnapshot();
+    m_updating = false;
 }
 
-void Entry::updateModifiedSinceBegin()
+void Entry::emitModified()
 {
+    updateTimeinfo();
     m_modifiedSinceBegin = true;
+
+    Q_EMIT modified();
+
+    // notified directly instead of through a connection per entry,
+    // the database coalesces the changes of a batch update
+    if (m_group && m_group->database()) {
+        m_group->database()->emitModifiedImmediate();
+    }
 }
 
 Group* Entry::group()
@@ -567,6 +770,10 @@ void Entry::setGroup(Group* group)
 void Entry::emitDataChanged()
 {
     Q_EMIT dataChanged(this);
+
+    if (m_group) {
+        Q_EMIT m_group->entryDataChanged(this);
+    }
 }
 
 const Database* Entry::database() const
@@ -51,6 +51,21 @@ struct EntryData
     TimeInfo timeInfo;
 };
 
+/**
+ * Plain copy of the data of an entry, used to store history items without
+ * the QObject and child objects of a full Entry.
+ * The attachment pool keys are referenced by the entry holding the snapshot.
+ */
+struct EntrySnapshot
+{
+    Uuid uuid;
+    EntryData data;
+    QMap<QString, QString> attributes;
+    QSet<QString> protectedAttributes;
+    QMap<QString, int> attachments;
+    QList<AutoTypeAssociations::Association> autoTypeAssociations;
+};
+
 class Entry : public QObject
 {
     Q_OBJECT
@@ -105,11 +120,36 @@ public:
     void setExpires(const bool& value);
     void setExpiryTime(const QDateTime& dateTime);
 
+    /**
+     * History items are stored as snapshots, the Entry objects are created
+     * on first access and kept until the item is removed.
+     * Changes to the returned entries aren't stored in the history.
+     */
     QList<Entry*> historyItems();
     const QList<Entry*>& historyItems() const;
+    /**
+     * Returns a single history item without creating the others.
+     */
+    Entry* historyItem(int index) const;
+    const QList<EntrySnapshot>& historySnapshots() const;
     void addHistoryItem(Entry* entry);
+    void addHistoryItem(const EntrySnapshot& snapshot);
     void removeHistoryItems(const QList<Entry*>& historyEntries);
     void truncateHistory();
+    /**
+     * Replaces the custom icon uuid with the default icon in all history items.
+     */
+    void resetHistoryIcon(const Uuid& uuid);
+
+    /**
+     * The attachment keys of the snapshot are only valid as long as this
+     * entry keeps its attachments.
+     */
+    EntrySnapshot snapshot() const;
+    /**
+     * Creates an entry that isn't part of any group from the snapshot.
+     */
+    static Entry* fromSnapshot(const EntrySnapshot& snapshot);
 
     enum CloneFlag {
         CloneNoFlags        = 0,
@@ -152,21 +192,31 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void emitDataChanged();
-    void updateTimeinfo();
-    void updateModifiedSinceBegin();
+    void emitModified();
 
 private:
     const Database* database() const;
+    void updateTimeinfo();
     template <class T> bool set(T& property, const T& value);
+    void appendHistory(const EntrySnapshot& snapshot);
+    void removeHistory(int index);
+    static void refAttachments(const EntrySnapshot& snapshot);
+    static void releaseAttachments(const EntrySnapshot& snapshot);
 
     Uuid m_uuid;
     EntryData m_data;
     EntryAttributes* const m_attributes;
-    EntryAttachments* const m_attachments;
-    AutoTypeAssociations* const m_autoTypeAssociations;
-
-    QList<Entry*> m_history;
-    Entry* m_tmpHistoryItem;
+    // attachments and associations are created on first non-const access,
+    // most entries and history items don't have any
+    EntryAttachments* m_attachments;
+    AutoTypeAssociations* m_autoTypeAssociations;
+
+    QList<EntrySnapshot> m_history;
+    // Entry objects for m_history, empty until the first one is created,
+    // afterwards Q_NULLPTR for the items that haven't been accessed
+    mutable QList<Entry*> m_historyEntries;
+    EntrySnapshot m_tmpHistoryItem;
+    bool m_updating;
     bool m_modifiedSinceBegin;
     QPointer<Group> m_group;
     mutable QPixmapCache::Key m_pixmapCacheKey;
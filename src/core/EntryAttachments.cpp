@@ -17,11 +17,18 @@
 
 #include "EntryAttachments.h"
 
+#include "core/AttachmentPool.h"
+
 EntryAttachments::EntryAttachments(QObject* parent)
     : QObject(parent)
 {
 }
 
+EntryAttachments::~EntryAttachments()
+{
+    releaseAll();
+}
+
 QList<QString> EntryAttachments::keys() const
 {
     return m_attachments.keys();
@@ -29,17 +36,41 @@ QList<QString> EntryAttachments::keys() const
 
 bool EntryAttachments::hasKey(const QString& key) const
 {
-    return m_attachments.keys().contains(key);
+    return m_attachments.contains(key);
 }
 
 QList<QByteArray> EntryAttachments::values() const
 {
-    return m_attachments.values();
+    QList<QByteArray> values;
+
+    QMap<QString, int>::const_iterator i;
+    for (i = m_attachments.constBegin(); i != m_attachments.constEnd(); ++i) {
+        values.append(attachmentPool()->data(i.value()));
+    }
+
+    return values;
 }
 
 QByteArray EntryAttachments::value(const QString& key) const
 {
-    return m_attachments.value(key);
+    QMap<QString, int>::const_iterator i = m_attachments.constFind(key);
+
+    if (i != m_attachments.constEnd()) {
+        return attachmentPool()->data(i.value());
+    }
+    else {
+        return QByteArray();
+    }
+}
+
+int EntryAttachments::poolKey(const QString& key) const
+{
+    return m_attachments.value(key, -1);
+}
+
+QList<int> EntryAttachments::poolKeys() const
+{
+    return m_attachments.values();
 }
 
 void EntryAttachments::set(const QString& key, const QByteArray& value)
@@ -51,10 +82,19 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
         Q_EMIT aboutToBeAdded(key);
     }
 
-    if (addAttachment || m_attachments.value(key) != value) {
-        m_attachments.insert(key, value);
+    int poolKey = attachmentPool()->add(value);
+
+    // equal data always maps to the same pool key
+    if (addAttachment || m_attachments.value(key) != poolKey) {
+        if (!addAttachment) {
+            attachmentPool()->release(m_attachments.value(key));
+        }
+        m_attachments.insert(key, poolKey);
         emitModified = true;
     }
+    else {
+        attachmentPool()->release(poolKey);
+    }
 
     if (addAttachment) {
         Q_EMIT added(key);
@@ -77,7 +117,7 @@ void EntryAttachments::remove(const QString& key)
 
     Q_EMIT aboutToBeRemoved(key);
 
-    m_attachments.remove(key);
+    attachmentPool()->release(m_attachments.take(key));
 
     Q_EMIT removed(key);
     Q_EMIT modified();
@@ -91,7 +131,7 @@ void EntryAttachments::clear()
 
     Q_EMIT aboutToBeReset();
 
-    m_attachments.clear();
+    releaseAll();
 
     Q_EMIT reset();
     Q_EMIT modified();
@@ -102,7 +142,11 @@ void EntryAttachments::copyDataFrom(const EntryAttachments* other)
     if (*this != *other) {
         Q_EMIT aboutToBeReset();
 
+        releaseAll();
         m_attachments = other->m_attachments;
+        Q_FOREACH (int poolKey, m_attachments) {
+            attachmentPool()->ref(poolKey);
+        }
 
         Q_EMIT reset();
         Q_EMIT modified();
@@ -118,3 +162,12 @@ bool EntryAttachments::operator!=(const EntryAttachments& other) const
 {
     return m_attachments != other.m_attachments;
 }
+
+void EntryAttachments::releaseAll()
+{
+    Q_FOREACH (int poolKey, m_attachments) {
+        attachmentPool()->release(poolKey);
+    }
+
+    m_attachments.clear();
+}
@@ -29,10 +29,13 @@ class EntryAttachments : public QObject
 
 public:
     explicit EntryAttachments(QObject* parent = Q_NULLPTR);
+    ~EntryAttachments();
     QList<QString> keys() const;
     bool hasKey(const QString& key) const;
     QList<QByteArray> values() const;
     QByteArray value(const QString& key) const;
+    int poolKey(const QString& key) const;
+    QList<int> poolKeys() const;
     void set(const QString& key, const QByteArray& value);
     void remove(const QString& key);
     void clear();
@@ -51,7 +54,13 @@ Q_SIGNALS:
     void reset();
 
 private:
-    QMap<QString, QByteArray> m_attachments;
+    // history snapshots copy the data without the signals
+    friend class Entry;
+
+    void releaseAll();
+
+    // maps attachment names to AttachmentPool keys
+    QMap<QString, int> m_attachments;
 };
 
 #endif // KEEPASSX_ENTRYATTACHMENTS_H
@@ -69,6 +69,9 @@ Q_SIGNALS:
     void reset();
 
 private:
+    // history snapshots copy the data without the signals
+    friend class Entry;
+
     QMap<QString, QString> m_attributes;
     QSet<QString> m_protectedAttributes;
 };
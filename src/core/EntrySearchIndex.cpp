@@ -0,0 +1,233 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntrySearchIndex.h"
+
+#include <QtAlgorithms>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+
+EntrySearchIndex::EntrySearchIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+    , m_built(false)
+    , m_deadCount(0)
+{
+}
+
+void EntrySearchIndex::addEntry(Entry* entry)
+{
+    // picked up by build() otherwise
+    if (m_built) {
+        m_dirty.insert(entry);
+    }
+}
+
+void EntrySearchIndex::removeEntry(Entry* entry)
+{
+    if (m_built) {
+        m_dirty.remove(entry);
+        unindexEntry(entry);
+    }
+}
+
+QSet<Entry*> EntrySearchIndex::search(const QStringList& words, Qt::CaseSensitivity caseSensitivity)
+{
+    if (m_built) {
+        update();
+    }
+    else {
+        build();
+    }
+
+    QStringList foldedWords;
+    Q_FOREACH (const QString& word, words) {
+        foldedWords.append(word.toCaseFolded());
+    }
+
+    // every trigram of the words has to occur in a matching entry so it's
+    // enough to check the entries of the shortest posting list
+    const QVector<int>* candidates = Q_NULLPTR;
+    Q_FOREACH (const QString& word, foldedWords) {
+        Q_FOREACH (quint64 trigram, trigrams(word)) {
+            QHash<quint64, QVector<int> >::const_iterator i = m_postings.constFind(trigram);
+            if (i == m_postings.constEnd()) {
+                return QSet<Entry*>();
+            }
+
+            if (!candidates || i.value().size() < candidates->size()) {
+                candidates = &i.value();
+            }
+        }
+    }
+
+    int candidateCount = candidates ? candidates->size() : m_entries.size();
+
+    QSet<Entry*> result;
+    for (int i = 0; i < candidateCount; i++) {
+        int id = candidates ? candidates->at(i) : i;
+        Entry* entry = m_entries.at(id);
+        if (!entry) {
+            continue;
+        }
+
+        const QString& text = m_texts.at(id);
+        bool match = true;
+        Q_FOREACH (const QString& word, foldedWords) {
+            if (!text.contains(word, Qt::CaseSensitive)) {
+                match = false;
+                break;
+            }
+        }
+
+        if (match && caseSensitivity == Qt::CaseSensitive) {
+            match = EntrySearcher::matchEntry(entry, words, caseSensitivity);
+        }
+
+        if (match) {
+            result.insert(entry);
+        }
+    }
+
+    return result;
+}
+
+void EntrySearchIndex::invalidateEntry(Entry* entry)
+{
+    m_dirty.insert(entry);
+}
+
+void EntrySearchIndex::build()
+{
+    Q_ASSERT(!m_built);
+
+    Q_FOREACH (Entry* entry, m_db->rootGroup()->entriesRecursive()) {
+        indexEntry(entry);
+    }
+
+    // one connection instead of one per entry
+    connect(m_db, SIGNAL(entryDataChanged(Entry*)), SLOT(invalidateEntry(Entry*)));
+    m_built = true;
+}
+
+void EntrySearchIndex::update()
+{
+    if (m_dirty.isEmpty()) {
+        return;
+    }
+
+    Q_FOREACH (Entry* entry, m_dirty) {
+        unindexEntry(entry);
+        indexEntry(entry);
+    }
+    m_dirty.clear();
+
+    if (m_deadCount > 1024 && m_deadCount > m_ids.size()) {
+        rebuild();
+    }
+}
+
+void EntrySearchIndex::indexEntry(Entry* entry)
+{
+    Q_ASSERT(!m_ids.contains(entry));
+
+    int id = m_entries.size();
+    QString text = searchableText(entry).toCaseFolded();
+
+    Q_FOREACH (quint64 trigram, trigrams(text)) {
+        m_postings[trigram].append(id);
+    }
+
+    m_entries.append(entry);
+    m_texts.append(text);
+    m_ids.insert(entry, id);
+}
+
+void EntrySearchIndex::unindexEntry(Entry* entry)
+{
+    QHash<Entry*, int>::iterator i = m_ids.find(entry);
+    if (i == m_ids.end()) {
+        return;
+    }
+
+    m_entries[i.value()] = Q_NULLPTR;
+    m_texts[i.value()].clear();
+    m_ids.erase(i);
+    m_deadCount++;
+}
+
+void EntrySearchIndex::rebuild()
+{
+    QList<Entry*> entries = m_ids.keys();
+
+    m_entries.clear();
+    m_texts.clear();
+    m_ids.clear();
+    m_postings.clear();
+    m_deadCount = 0;
+
+    Q_FOREACH (Entry* entry, entries) {
+        indexEntry(entry);
+    }
+}
+
+QString EntrySearchIndex::searchableText(const Entry* entry)
+{
+    // search words never contain whitespace so they can't match across
+    // the field separator
+    QString text;
+    text.append(entry->title()).append('\n');
+    text.append(entry->username()).append('\n');
+    text.append(entry->url()).append('\n');
+    text.append(entry->notes());
+
+    return text;
+}
+
+QVector<quint64> EntrySearchIndex::trigrams(const QString& text)
+{
+    QVector<quint64> result;
+
+    const QChar* data = text.unicode();
+    int count = text.size() - 2;
+    if (count <= 0) {
+        return result;
+    }
+
+    result.reserve(count);
+    for (int i = 0; i < count; i++) {
+        result.append((static_cast<quint64>(data[i].unicode()) << 32)
+                      | (static_cast<quint64>(data[i + 1].unicode()) << 16)
+                      | static_cast<quint64>(data[i + 2].unicode()));
+    }
+
+    qSort(result);
+
+    // remove duplicates
+    int size = 0;
+    for (int i = 0; i < result.size(); i++) {
+        if (size == 0 || result.at(i) != result.at(size - 1)) {
+            result[size++] = result.at(i);
+        }
+    }
+    result.resize(size);
+
+    return result;
+}
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_ENTRYSEARCHINDEX_H
+#define KEEPASSX_ENTRYSEARCHINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include "core/Global.h"
+
+class Database;
+class Entry;
+
+/**
+ * Trigram index over the title, username, url and notes of the entries of
+ * a database.
+ *
+ * Nothing is indexed until the first search, which indexes all entries of
+ * the database at once. From then on entries are (re)indexed lazily on the
+ * next search after they have been added or their data has changed. Every
+ * match found through the index is verified against the entry text, so the
+ * results are the same as searching each entry with QString::contains().
+ */
+class EntrySearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntrySearchIndex(Database* db);
+    void addEntry(Entry* entry);
+    void removeEntry(Entry* entry);
+
+    /**
+     * Returns all indexed entries that contain every word of words in one of
+     * the searchable fields.
+     */
+    QSet<Entry*> search(const QStringList& words, Qt::CaseSensitivity caseSensitivity);
+
+private Q_SLOTS:
+    void invalidateEntry(Entry* entry);
+
+private:
+    void build();
+    void update();
+    void indexEntry(Entry* entry);
+    void unindexEntry(Entry* entry);
+    void rebuild();
+    static QString searchableText(const Entry* entry);
+    static QVector<quint64> trigrams(const QString& text);
+
+    Database* const m_db;
+    bool m_built;
+
+    // every version of an indexed entry gets a new id, the posting lists
+    // are only cleaned up when the index is rebuilt
+    QVector<Entry*> m_entries;
+    QVector<QString> m_texts;
+    QHash<Entry*, int> m_ids;
+    QHash<quint64, QVector<int> > m_postings;
+    QSet<Entry*> m_dirty;
+    int m_deadCount;
+};
+
+#endif // KEEPASSX_ENTRYSEARCHINDEX_H
@@ -17,46 +17,127 @@
 
 #include "EntrySearcher.h"
 
+#include "core/Database.h"
+#include "core/EntrySearchIndex.h"
 #include "core/Group.h"
+#include "core/ParallelEntryFilter.h"
+
+namespace {
+
+class WordMatcher : public EntryMatcher
+{
+public:
+    WordMatcher(const QStringList& words, Qt::CaseSensitivity caseSensitivity)
+        : m_words(words)
+        , m_caseSensitivity(caseSensitivity)
+    {
+    }
+
+    bool matches(const Entry* entry) const Q_DECL_OVERRIDE
+    {
+        return EntrySearcher::matchEntry(entry, m_words, m_caseSensitivity);
+    }
+
+private:
+    const QStringList m_words;
+    const Qt::CaseSensitivity m_caseSensitivity;
+};
+
+} // namespace
 
 QList<Entry*> EntrySearcher::search(const QString &searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity)
+{
+    return searchInGroup(searchWords(searchTerm), group, caseSensitivity);
+}
+
+QStringList EntrySearcher::searchWords(const QString& searchTerm)
+{
+    return searchTerm.split(QRegExp("\\s"), QString::SkipEmptyParts);
+}
+
+bool EntrySearcher::matchEntry(const Entry* entry, const QStringList& words, Qt::CaseSensitivity caseSensitivity)
+{
+    Q_FOREACH (const QString& word, words) {
+        if (!wordMatch(word, entry, caseSensitivity)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QList<Entry*> EntrySearcher::searchInGroup(const QStringList& words, const Group* group,
+                                           Qt::CaseSensitivity caseSensitivity)
 {
     if (!group->resolveSearchingEnabled()) {
         return QList<Entry*>();
     }
 
-    return searchEntries(searchTerm, group, caseSensitivity);
+    const Database* db = group->database();
+    if (db && !words.isEmpty()) {
+        QSet<Entry*> matches = db->searchIndex()->search(words, caseSensitivity);
+
+        QList<Entry*> searchResult;
+        if (!matches.isEmpty()) {
+            filterEntries(matches, group, searchResult);
+        }
+        return searchResult;
+    }
+
+    return searchEntries(words, group, caseSensitivity);
 }
 
-QList<Entry*> EntrySearcher::searchEntries(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity)
+QList<Entry*> EntrySearcher::searchEntries(const QStringList& words, const Group* group, Qt::CaseSensitivity caseSensitivity)
 {
-    QList<Entry*> searchResult;
+    QList<const Group*> groups;
+    groups.append(group);
 
+    return ParallelEntryFilter::filter(ParallelEntryFilter::entries(groups, true),
+                                       WordMatcher(words, caseSensitivity));
+}
+
+void EntrySearcher::filterEntries(const QSet<Entry*>& matches, const Group* group, QList<Entry*>& result)
+{
+    // walk the tree to keep the order of the entries and to skip groups
+    // that have searching disabled
     Q_FOREACH (Entry* entry, group->entries()) {
-        searchResult.append(matchEntry(searchTerm, entry, caseSensitivity));
+        if (matches.contains(entry)) {
+            result.append(entry);
+        }
     }
     Q_FOREACH (Group* childGroup, group->children()) {
+        if (result.size() == matches.size()) {
+            return;
+        }
         if (childGroup->searchingEnabled() != Group::Disable) {
-            searchResult.append(searchEntries(searchTerm, childGroup, caseSensitivity));
+            filterEntries(matches, childGroup, result);
         }
     }
-
-    return searchResult;
 }
 
-QList<Entry*> EntrySearcher::matchEntry(const QString& searchTerm, Entry* entry, Qt::CaseSensitivity caseSensitivity)
+bool EntrySearcher::isRefinement(const QStringList& oldWords, const QStringList& newWords,
+                                 Qt::CaseSensitivity caseSensitivity)
 {
-    QStringList wordList = searchTerm.split(QRegExp("\\s"), QString::SkipEmptyParts);
-    Q_FOREACH (const QString& word, wordList) {
-        if (!wordMatch(word, entry, caseSensitivity)) {
-            return QList<Entry*>();
+    // every entry that matches the new words also matches the old ones if
+    // each old word is part of a new word
+    Q_FOREACH (const QString& oldWord, oldWords) {
+        bool found = false;
+        Q_FOREACH (const QString& newWord, newWords) {
+            if (newWord.contains(oldWord, caseSensitivity)) {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            return false;
         }
     }
 
-    return QList<Entry*>() << entry;
+    return true;
 }
 
-bool EntrySearcher::wordMatch(const QString& word, Entry* entry, Qt::CaseSensitivity caseSensitivity)
+bool EntrySearcher::wordMatch(const QString& word, const Entry* entry, Qt::CaseSensitivity caseSensitivity)
 {
     return entry->title().contains(word, caseSensitivity) ||
             entry->username().contains(word, caseSensitivity) ||
@@ -18,7 +18,8 @@
 #ifndef KEEPASSX_ENTRYSEARCHER_H
 #define KEEPASSX_ENTRYSEARCHER_H
 
-#include <QString>
+#include <QSet>
+#include <QStringList>
 
 
 class Group;
@@ -28,10 +29,21 @@ class EntrySearcher
 {
 public:
     QList<Entry*> search(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity);
+
+    static QStringList searchWords(const QString& searchTerm);
+    static bool matchEntry(const Entry* entry, const QStringList& words, Qt::CaseSensitivity caseSensitivity);
+
+    /**
+     * Returns true if every entry that matches newWords also matches oldWords.
+     */
+    static bool isRefinement(const QStringList& oldWords, const QStringList& newWords,
+                             Qt::CaseSensitivity caseSensitivity);
+
 private:
-    QList<Entry*> searchEntries(const QString& searchTerm, const Group* group, Qt::CaseSensitivity caseSensitivity);
-    QList<Entry*> matchEntry(const QString& searchTerm, Entry* entry, Qt::CaseSensitivity caseSensitivity);
-    bool wordMatch(const QString &word, Entry *entry, Qt::CaseSensitivity caseSensitivity);
+    QList<Entry*> searchInGroup(const QStringList& words, const Group* group, Qt::CaseSensitivity caseSensitivity);
+    QList<Entry*> searchEntries(const QStringList& words, const Group* group, Qt::CaseSensitivity caseSensitivity);
+    void filterEntries(const QSet<Entry*>& matches, const Group* group, QList<Entry*>& result);
+    static bool wordMatch(const QString& word, const Entry* entry, Qt::CaseSensitivity caseSensitivity);
 };
 
 #endif // KEEPASSX_ENTRYSEARCHER_H
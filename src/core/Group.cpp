@@ -21,12 +21,16 @@
 #include "core/DatabaseIcons.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
+#include "core/TreeIterator.h"
 
 const int Group::DefaultIconNumber = 48;
 const int Group::RecycleBinIconNumber = 43;
 
 Group::Group()
     : m_updateTimeinfo(true)
+    , m_inheritanceResolved(false)
+    , m_resolvedSearchingEnabled(true)
+    , m_resolvedAutoTypeEnabled(true)
 {
     m_data.iconNumber = DefaultIconNumber;
     m_data.isExpanded = true;
@@ -55,6 +59,10 @@ Group::~Group()
         m_db->addDeletedObject(delGroup);
     }
 
+    if (m_db) {
+        m_db->removeFromIndex(m_uuid, this);
+    }
+
     cleanupParent();
 }
 
@@ -191,7 +199,11 @@ bool Group::isExpired() const
 
 void Group::setUuid(const Uuid& uuid)
 {
-    set(m_uuid, uuid);
+    Uuid oldUuid = m_uuid;
+    if (set(m_uuid, uuid) && m_db) {
+        m_db->removeFromIndex(oldUuid, this);
+        m_db->addToIndex(this);
+    }
 }
 
 void Group::setName(const QString& name)
@@ -254,17 +266,23 @@ void Group::setExpanded(bool expanded)
 
 void Group::setDefaultAutoTypeSequence(const QString& sequence)
 {
-    set(m_data.defaultAutoTypeSequence, sequence);
+    if (set(m_data.defaultAutoTypeSequence, sequence)) {
+        invalidateInheritance();
+    }
 }
 
 void Group::setAutoTypeEnabled(TriState enable)
 {
-    set(m_data.autoTypeEnabled, enable);
+    if (set(m_data.autoTypeEnabled, enable)) {
+        invalidateInheritance();
+    }
 }
 
 void Group::setSearchingEnabled(TriState enable)
 {
-    set(m_data.searchingEnabled, enable);
+    if (set(m_data.searchingEnabled, enable)) {
+        invalidateInheritance();
+    }
 }
 
 void Group::setLastTopVisibleEntry(Entry* entry)
@@ -351,6 +369,8 @@ void Group::setParent(Group* parent, int index)
         parent->m_children.insert(index, this);
     }
 
+    invalidateInheritance();
+
     if (m_updateTimeinfo) {
         m_data.timeInfo.setLocationChanged(Tools::currentDateTimeUtc());
     }
@@ -373,6 +393,7 @@ void Group::setParent(Database* db)
     cleanupParent();
 
     m_parent = Q_NULLPTR;
+    invalidateInheritance();
     recSetDatabase(db);
 
     QObject::setParent(db);
@@ -412,16 +433,9 @@ QList<Entry*> Group::entriesRecursive(bool includeHistoryItems) const
 {
     QList<Entry*> entryList;
 
-    entryList.append(m_entries);
-
-    if (includeHistoryItems) {
-        Q_FOREACH (Entry* entry, m_entries) {
-            entryList.append(entry->historyItems());
-        }
-    }
-
-    Q_FOREACH (Group* group, m_children) {
-        entryList.append(group->entriesRecursive(includeHistoryItems));
+    EntryIterator i(this, includeHistoryItems);
+    while (i.hasNext()) {
+        entryList.append(i.next());
     }
 
     return entryList;
@@ -430,12 +444,10 @@ QList<Entry*> Group::entriesRecursive(bool includeHistoryItems) const
 QList<const Group*> Group::groupsRecursive(bool includeSelf) const
 {
     QList<const Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
 
-    Q_FOREACH (Group* group, m_children) {
-        groupList.append(group->groupsRecursive(true));
+    GroupIterator i(this, includeSelf);
+    while (i.hasNext()) {
+        groupList.append(i.next());
     }
 
     return groupList;
@@ -445,18 +457,26 @@ QSet<Uuid> Group::customIconsRecursive() const
 {
     QSet<Uuid> result;
 
-    if (!iconUuid().isNull()) {
-        result.insert(iconUuid());
+    GroupIterator groups(this);
+    while (groups.hasNext()) {
+        const Group* group = groups.next();
+        if (!group->iconUuid().isNull()) {
+            result.insert(group->iconUuid());
+        }
     }
 
-    Q_FOREACH (Entry* entry, entriesRecursive(true)) {
+    EntryIterator entries(this);
+    while (entries.hasNext()) {
+        const Entry* entry = entries.next();
         if (!entry->iconUuid().isNull()) {
             result.insert(entry->iconUuid());
         }
-    }
 
-    Q_FOREACH (Group* group, m_children) {
-        result.unite(group->customIconsRecursive());
+        Q_FOREACH (const EntrySnapshot& historyItem, entry->historySnapshots()) {
+            if (!historyItem.data.customIcon.isNull()) {
+                result.insert(historyItem.data.customIcon);
+            }
+        }
     }
 
     return result;
@@ -496,6 +516,7 @@ void Group::copyDataFrom(const Group* other)
 {
     m_data = other->m_data;
     m_lastTopVisibleEntry = other->m_lastTopVisibleEntry;
+    invalidateInheritance();
 }
 
 void Group::addEntry(Entry* entry)
@@ -506,9 +527,8 @@ void Group::addEntry(Entry* entry)
     Q_EMIT entryAboutToAdd(entry);
 
     m_entries << entry;
-    connect(entry, SIGNAL(dataChanged(Entry*)), SIGNAL(entryDataChanged(Entry*)));
     if (m_db) {
-        connect(entry, SIGNAL(modified()), m_db, SIGNAL(modifiedImmediate()));
+        m_db->addToIndex(entry);
     }
 
     Q_EMIT modified();
@@ -521,9 +541,8 @@ void Group::removeEntry(Entry* entry)
 
     Q_EMIT entryAboutToRemove(entry);
 
-    entry->disconnect(this);
     if (m_db) {
-        entry->disconnect(m_db);
+        m_db->removeFromIndex(entry->uuid(), entry);
     }
     m_entries.removeAll(entry);
     Q_EMIT modified();
@@ -540,15 +559,21 @@ void Group::recSetDatabase(Database* db)
         disconnect(SIGNAL(added()), m_db);
         disconnect(SIGNAL(aboutToMove(Group*,Group*,int)), m_db);
         disconnect(SIGNAL(moved()), m_db);
+        disconnect(SIGNAL(entryAboutToAdd(Entry*)), m_db);
+        disconnect(SIGNAL(entryAdded(Entry*)), m_db);
+        disconnect(SIGNAL(entryAboutToRemove(Entry*)), m_db);
+        disconnect(SIGNAL(entryRemoved(Entry*)), m_db);
+        disconnect(SIGNAL(entryDataChanged(Entry*)), m_db);
         disconnect(SIGNAL(modified()), m_db);
+        m_db->removeFromIndex(m_uuid, this);
     }
 
     Q_FOREACH (Entry* entry, m_entries) {
         if (m_db) {
-            entry->disconnect(m_db);
+            m_db->removeFromIndex(entry->uuid(), entry);
         }
         if (db) {
-            connect(entry, SIGNAL(modified()), db, SIGNAL(modifiedImmediate()));
+            db->addToIndex(entry);
         }
     }
 
@@ -560,7 +585,13 @@ void Group::recSetDatabase(Database* db)
         connect(this, SIGNAL(added()), db, SIGNAL(groupAdded()));
         connect(this, SIGNAL(aboutToMove(Group*,Group*,int)), db, SIGNAL(groupAboutToMove(Group*,Group*,int)));
         connect(this, SIGNAL(moved()), db, SIGNAL(groupMoved()));
-        connect(this, SIGNAL(modified()), db, SIGNAL(modifiedImmediate()));
+        connect(this, SIGNAL(entryAboutToAdd(Entry*)), db, SIGNAL(entryAboutToAdd(Entry*)));
+        connect(this, SIGNAL(entryAdded(Entry*)), db, SIGNAL(entryAdded(Entry*)));
+        connect(this, SIGNAL(entryAboutToRemove(Entry*)), db, SIGNAL(entryAboutToRemove(Entry*)));
+        connect(this, SIGNAL(entryRemoved(Entry*)), db, SIGNAL(entryRemoved(Entry*)));
+        connect(this, SIGNAL(entryDataChanged(Entry*)), db, SIGNAL(entryDataChanged(Entry*)));
+        connect(this, SIGNAL(modified()), db, SLOT(emitModifiedImmediate()));
+        db->addToIndex(this);
     }
 
     m_db = db;
@@ -596,40 +627,74 @@ void Group::recCreateDelObjects()
 
 bool Group::resolveSearchingEnabled() const
 {
-    switch (m_data.searchingEnabled) {
-    case Inherit:
-        if (!m_parent) {
-            return true;
-        }
-        else {
-            return m_parent->resolveSearchingEnabled();
-        }
-    case Enable:
-        return true;
-    case Disable:
-        return false;
-    default:
-        Q_ASSERT(false);
-        return false;
-    }
+    resolveInheritance();
+    return m_resolvedSearchingEnabled;
 }
 
 bool Group::resolveAutoTypeEnabled() const
 {
-    switch (m_data.autoTypeEnabled) {
-    case Inherit:
-        if (!m_parent) {
-            return true;
-        }
-        else {
-            return m_parent->resolveAutoTypeEnabled();
-        }
-    case Enable:
-        return true;
-    case Disable:
-        return false;
-    default:
-        Q_ASSERT(false);
-        return false;
+    resolveInheritance();
+    return m_resolvedAutoTypeEnabled;
+}
+
+QString Group::resolveDefaultAutoTypeSequence() const
+{
+    resolveInheritance();
+    return m_resolvedAutoTypeSequence;
+}
+
+void Group::resolveInheritance() const
+{
+    if (m_inheritanceResolved) {
+        return;
+    }
+
+    bool parentSearchingEnabled = true;
+    bool parentAutoTypeEnabled = true;
+    QString parentAutoTypeSequence;
+
+    if (m_parent) {
+        m_parent->resolveInheritance();
+        parentSearchingEnabled = m_parent->m_resolvedSearchingEnabled;
+        parentAutoTypeEnabled = m_parent->m_resolvedAutoTypeEnabled;
+        parentAutoTypeSequence = m_parent->m_resolvedAutoTypeSequence;
+    }
+
+    if (m_data.searchingEnabled == Inherit) {
+        m_resolvedSearchingEnabled = parentSearchingEnabled;
+    }
+    else {
+        m_resolvedSearchingEnabled = (m_data.searchingEnabled == Enable);
+    }
+
+    if (m_data.autoTypeEnabled == Inherit) {
+        m_resolvedAutoTypeEnabled = parentAutoTypeEnabled;
+    }
+    else {
+        m_resolvedAutoTypeEnabled = (m_data.autoTypeEnabled == Enable);
+    }
+
+    if (m_data.defaultAutoTypeSequence.isEmpty()) {
+        m_resolvedAutoTypeSequence = parentAutoTypeSequence;
+    }
+    else {
+        m_resolvedAutoTypeSequence = m_data.defaultAutoTypeSequence;
+    }
+
+    m_inheritanceResolved = true;
+}
+
+void Group::invalidateInheritance()
+{
+    // the children can't be resolved if this group isn't
+    if (!m_inheritanceResolved) {
+        return;
+    }
+
+    m_inheritanceResolved = false;
+    m_resolvedAutoTypeSequence.clear();
+
+    Q_FOREACH (Group* group, m_children) {
+        group->invalidateInheritance();
     }
 }
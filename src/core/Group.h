@@ -67,6 +67,11 @@ public:
     Group::TriState searchingEnabled() const;
     bool resolveSearchingEnabled() const;
     bool resolveAutoTypeEnabled() const;
+    /**
+     * Returns the default auto-type sequence of this group or of the
+     * closest parent group that has one.
+     */
+    QString resolveDefaultAutoTypeSequence() const;
     Entry* lastTopVisibleEntry() const;
     bool isExpired() const;
 
@@ -145,6 +150,8 @@ private:
     void cleanupParent();
     void recCreateDelObjects();
     void updateTimeinfo();
+    void resolveInheritance() const;
+    void invalidateInheritance();
 
     QPointer<Database> m_db;
     Uuid m_uuid;
@@ -158,9 +165,16 @@ private:
 
     bool m_updateTimeinfo;
 
+    // inherited settings, only valid if the parent group's are valid too
+    mutable bool m_inheritanceResolved;
+    mutable bool m_resolvedSearchingEnabled;
+    mutable bool m_resolvedAutoTypeEnabled;
+    mutable QString m_resolvedAutoTypeSequence;
+
     friend void Database::setRootGroup(Group* group);
-    friend Entry::~Entry();
-    friend void Entry::setGroup(Group* group);
+    // entries add and remove themselves and emit entryDataChanged() directly
+    // instead of through a connection per entry
+    friend class Entry;
 };
 
 #endif // KEEPASSX_GROUP_H
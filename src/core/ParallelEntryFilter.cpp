@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelEntryFilter.h"
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "core/Group.h"
+#include "core/TreeIterator.h"
+
+const int ParallelEntryFilter::MinChunkSize = 512;
+
+namespace {
+
+struct IndexChunk
+{
+    int begin;
+    int end;
+    const IndexMatcher* matcher;
+};
+
+QVector<int> filterChunk(const IndexChunk& chunk)
+{
+    QVector<int> result;
+
+    for (int i = chunk.begin; i < chunk.end; i++) {
+        if (chunk.matcher->matches(i)) {
+            result.append(i);
+        }
+    }
+
+    return result;
+}
+
+class EntryListMatcher : public IndexMatcher
+{
+public:
+    EntryListMatcher(const QList<Entry*>& entries, const EntryMatcher& matcher)
+        : m_entries(entries)
+        , m_matcher(matcher)
+    {
+    }
+
+    bool matches(int index) const Q_DECL_OVERRIDE
+    {
+        return m_matcher.matches(m_entries.at(index));
+    }
+
+private:
+    const QList<Entry*>& m_entries;
+    const EntryMatcher& m_matcher;
+};
+
+} // namespace
+
+QList<Entry*> ParallelEntryFilter::filter(const QList<Entry*>& entries, const EntryMatcher& matcher)
+{
+    QVector<int> indexes = filterIndexes(0, entries.size(), EntryListMatcher(entries, matcher));
+
+    QList<Entry*> result;
+    Q_FOREACH (int index, indexes) {
+        result.append(entries.at(index));
+    }
+
+    return result;
+}
+
+QVector<int> ParallelEntryFilter::filterIndexes(int begin, int end, const IndexMatcher& matcher)
+{
+    int threads = qMax(QThread::idealThreadCount(), 1);
+    int count = end - begin;
+
+    IndexChunk chunk;
+    chunk.begin = begin;
+    chunk.end = end;
+    chunk.matcher = &matcher;
+
+    if (threads == 1 || count <= MinChunkSize) {
+        return filterChunk(chunk);
+    }
+
+    // use a few chunks per thread so uneven chunks are balanced out
+    int chunkSize = qMax(MinChunkSize, (count + threads * 4 - 1) / (threads * 4));
+
+    QList<IndexChunk> chunks;
+    for (int chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+        chunk.begin = chunkBegin;
+        chunk.end = qMin(chunkBegin + chunkSize, end);
+        chunks.append(chunk);
+    }
+
+    // blockingMapped() returns the results in the order of the chunks
+    QList<QVector<int> > chunkResults = QtConcurrent::blockingMapped(chunks, filterChunk);
+
+    QVector<int> result;
+    Q_FOREACH (const QVector<int>& chunkResult, chunkResults) {
+        result += chunkResult;
+    }
+
+    return result;
+}
+
+QList<Entry*> ParallelEntryFilter::entries(const QList<const Group*>& groups, bool searchableOnly)
+{
+    QList<Entry*> result;
+
+    Q_FOREACH (const Group* root, groups) {
+        if (searchableOnly && !root->resolveSearchingEnabled()) {
+            continue;
+        }
+
+        GroupIterator i(root);
+        while (i.hasNext()) {
+            const Group* group = i.next();
+            if (searchableOnly && group != root && group->searchingEnabled() == Group::Disable) {
+                i.skipChildren();
+                continue;
+            }
+
+            result.append(group->entries());
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PARALLELENTRYFILTER_H
+#define KEEPASSX_PARALLELENTRYFILTER_H
+
+#include <QList>
+#include <QVector>
+
+#include "core/Global.h"
+
+class Entry;
+class Group;
+
+/**
+ * Predicate for ParallelEntryFilter.
+ *
+ * matches() is called from worker threads so it may only read entries
+ * and groups and must not touch any other shared state.
+ */
+class EntryMatcher
+{
+public:
+    virtual ~EntryMatcher() {}
+    virtual bool matches(const Entry* entry) const = 0;
+};
+
+/**
+ * Predicate for ParallelEntryFilter::filterIndexes(), for lists of other
+ * items than entries like snapshots of entry fields.
+ *
+ * matches() is called from worker threads with the same restrictions as
+ * EntryMatcher::matches().
+ */
+class IndexMatcher
+{
+public:
+    virtual ~IndexMatcher() {}
+    virtual bool matches(int index) const = 0;
+};
+
+/**
+ * Filters entries on the global thread pool.
+ *
+ * The entries are split into chunks that are matched concurrently,
+ * the result keeps the order of the input list.
+ */
+class ParallelEntryFilter
+{
+public:
+    static QList<Entry*> filter(const QList<Entry*>& entries, const EntryMatcher& matcher);
+
+    /**
+     * Returns the indexes in [begin, end) that match, in ascending order.
+     */
+    static QVector<int> filterIndexes(int begin, int end, const IndexMatcher& matcher);
+
+    /**
+     * Returns the entries of all groups in tree order. If searchableOnly
+     * is true subtrees that have searching disabled are skipped.
+     */
+    static QList<Entry*> entries(const QList<const Group*>& groups, bool searchableOnly = false);
+
+    static const int MinChunkSize;
+};
+
+#endif // KEEPASSX_PARALLELENTRYFILTER_H
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TreeIterator.h"
+
+#include "core/Entry.h"
+#include "core/Group.h"
+
+GroupIterator::GroupIterator(const Group* root, bool includeRoot)
+    : m_root(root)
+    , m_current(Q_NULLPTR)
+    , m_next(root)
+    , m_skipChildren(false)
+{
+    if (!includeRoot) {
+        m_current = root;
+        advance();
+    }
+}
+
+bool GroupIterator::hasNext() const
+{
+    return m_next;
+}
+
+const Group* GroupIterator::next()
+{
+    Q_ASSERT(m_next);
+
+    m_current = m_next;
+    m_skipChildren = false;
+    advance();
+
+    return m_current;
+}
+
+void GroupIterator::skipChildren()
+{
+    Q_ASSERT(m_current);
+
+    if (m_skipChildren) {
+        return;
+    }
+
+    m_skipChildren = true;
+
+    // next() already stepped into the children
+    if (!m_current->children().isEmpty()) {
+        m_childIndexes.removeLast();
+        advance();
+    }
+}
+
+void GroupIterator::advance()
+{
+    const Group* group = m_current;
+
+    if (!m_skipChildren && !group->children().isEmpty()) {
+        m_childIndexes.append(0);
+        m_next = group->children().first();
+        return;
+    }
+
+    while (group != m_root) {
+        const QList<Group*>& siblings = group->parentGroup()->children();
+        int index = m_childIndexes.last() + 1;
+
+        if (index < siblings.size()) {
+            m_childIndexes[m_childIndexes.size() - 1] = index;
+            m_next = siblings.at(index);
+            return;
+        }
+
+        m_childIndexes.removeLast();
+        group = group->parentGroup();
+    }
+
+    m_next = Q_NULLPTR;
+}
+
+EntryIterator::EntryIterator(const Group* root, bool includeHistoryItems)
+    : m_groups(root)
+    , m_group(m_groups.next())
+    , m_includeHistoryItems(includeHistoryItems)
+    , m_entryIndex(0)
+    , m_historyEntryIndex(0)
+    , m_historyIndex(0)
+    , m_next(Q_NULLPTR)
+{
+    findNext();
+}
+
+bool EntryIterator::hasNext() const
+{
+    return m_next;
+}
+
+Entry* EntryIterator::next()
+{
+    Q_ASSERT(m_next);
+
+    Entry* entry = m_next;
+    findNext();
+
+    return entry;
+}
+
+void EntryIterator::findNext()
+{
+    while (m_group) {
+        const QList<Entry*>& entries = m_group->entries();
+
+        if (m_entryIndex < entries.size()) {
+            m_next = entries.at(m_entryIndex++);
+            return;
+        }
+
+        if (m_includeHistoryItems) {
+            while (m_historyEntryIndex < entries.size()) {
+                const Entry* entry = entries.at(m_historyEntryIndex);
+
+                // only the returned history items are created
+                if (m_historyIndex < entry->historySnapshots().size()) {
+                    m_next = entry->historyItem(m_historyIndex++);
+                    return;
+                }
+
+                m_historyEntryIndex++;
+                m_historyIndex = 0;
+            }
+        }
+
+        m_group = m_groups.hasNext() ? m_groups.next() : Q_NULLPTR;
+        m_entryIndex = 0;
+        m_historyEntryIndex = 0;
+        m_historyIndex = 0;
+    }
+
+    m_next = Q_NULLPTR;
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_TREEITERATOR_H
+#define KEEPASSX_TREEITERATOR_H
+
+#include <QVarLengthArray>
+
+#include "core/Global.h"
+
+class Entry;
+class Group;
+
+/**
+ * Depth-first iterator over a group and its descendants.
+ *
+ * Groups are returned in the order of groupsRecursive() without building
+ * a list. The tree must not be modified while iterating.
+ */
+class GroupIterator
+{
+public:
+    explicit GroupIterator(const Group* root, bool includeRoot = true);
+
+    bool hasNext() const;
+    const Group* next();
+
+    /**
+     * Don't descend into the children of the group that was returned by
+     * the last call to next().
+     */
+    void skipChildren();
+
+private:
+    void advance();
+
+    const Group* const m_root;
+    const Group* m_current;
+    const Group* m_next;
+    bool m_skipChildren;
+    // index of the current child on each level below the root
+    QVarLengthArray<int, 16> m_childIndexes;
+};
+
+/**
+ * Depth-first iterator over the entries of a group and its descendants.
+ *
+ * Entries are returned in the order of entriesRecursive(), history items
+ * follow the entries of their group. The tree must not be modified while
+ * iterating.
+ */
+class EntryIterator
+{
+public:
+    explicit EntryIterator(const Group* root, bool includeHistoryItems = false);
+
+    bool hasNext() const;
+    Entry* next();
+
+private:
+    void findNext();
+
+    GroupIterator m_groups;
+    const Group* m_group;
+    const bool m_includeHistoryItems;
+    int m_entryIndex;
+    int m_historyEntryIndex;
+    int m_historyIndex;
+    Entry* m_next;
+};
+
+#endif // KEEPASSX_TREEITERATOR_H
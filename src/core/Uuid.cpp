@@ -17,22 +17,31 @@
 
 #include "Uuid.h"
 
-#include <QHash>
+#include <cstring>
+
+#include <QDataStream>
 
 #include "crypto/Random.h"
 
 const int Uuid::Length = 16;
 
 Uuid::Uuid()
-    : m_data(Length, 0)
 {
+    m_data[0] = 0;
+    m_data[1] = 0;
 }
 
 Uuid::Uuid(const QByteArray& data)
 {
     Q_ASSERT(data.size() == Length);
 
-    m_data = data;
+    if (data.size() == Length) {
+        memcpy(m_data, data.constData(), Length);
+    }
+    else {
+        m_data[0] = 0;
+        m_data[1] = 0;
+    }
 }
 
 Uuid Uuid::random()
@@ -42,45 +51,17 @@ Uuid Uuid::random()
 
 QString Uuid::toBase64() const
 {
-    return QString::fromLatin1(m_data.toBase64());
+    return QString::fromLatin1(toByteArray().toBase64());
 }
 
 QString Uuid::toHex() const
 {
-    return QString::fromLatin1(m_data.toHex());
+    return QString::fromLatin1(toByteArray().toHex());
 }
 
 QByteArray Uuid::toByteArray() const
 {
-    return m_data;
-}
-
-bool Uuid::isNull() const
-{
-    for (int i = 0; i < m_data.size(); ++i) {
-        if (m_data[i] != 0) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-Uuid& Uuid::operator=(const Uuid& other)
-{
-    m_data = other.m_data;
-
-    return *this;
-}
-
-bool Uuid::operator==(const Uuid& other) const
-{
-    return m_data == other.m_data;
-}
-
-bool Uuid::operator!=(const Uuid& other) const
-{
-    return !operator==(other);
+    return QByteArray(reinterpret_cast<const char*>(m_data), Length);
 }
 
 Uuid Uuid::fromBase64(const QString& str)
@@ -89,11 +70,6 @@ Uuid Uuid::fromBase64(const QString& str)
     return Uuid(data);
 }
 
-uint qHash(const Uuid& key)
-{
-    return qHash(key.toByteArray());
-}
-
 QDataStream& operator<<(QDataStream& stream, const Uuid& uuid)
 {
     return stream << uuid.toByteArray();
@@ -32,19 +32,42 @@ public:
     QByteArray toByteArray() const;
 
     bool isNull() const;
-    Uuid& operator=(const Uuid& other);
     bool operator==(const Uuid& other) const;
     bool operator!=(const Uuid& other) const;
     static const int Length;
     static Uuid fromBase64(const QString& str);
 
 private:
-    QByteArray m_data;
+    // the 16 bytes in their original order, stored as two words so
+    // comparing and hashing is cheap
+    quint64 m_data[2];
+
+    friend uint qHash(const Uuid& key);
 };
 
 Q_DECLARE_TYPEINFO(Uuid, Q_MOVABLE_TYPE);
 
-uint qHash(const Uuid& key);
+inline bool Uuid::isNull() const
+{
+    return (m_data[0] | m_data[1]) == 0;
+}
+
+inline bool Uuid::operator==(const Uuid& other) const
+{
+    return m_data[0] == other.m_data[0] && m_data[1] == other.m_data[1];
+}
+
+inline bool Uuid::operator!=(const Uuid& other) const
+{
+    return !operator==(other);
+}
+
+inline uint qHash(const Uuid& key)
+{
+    // uuids are mostly random, mix the words so structured ones hash well too
+    quint64 hash = (key.m_data[0] * Q_UINT64_C(0x9E3779B97F4A7C15)) ^ key.m_data[1];
+    return static_cast<uint>(hash ^ (hash >> 32));
+}
 
 QDataStream& operator<<(QDataStream& stream, const Uuid& uuid);
 QDataStream& operator>>(QDataStream& stream, Uuid& uuid);
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AesKdf.h"
+
+#include <QtConcurrentRun>
+
+#include "config-keepassx.h"
+#include "crypto/SymmetricCipher.h"
+
+#ifdef HAVE_AESNI
+#include "crypto/AesKdfAesNi.h"
+#endif
+
+AesKdf::AesKdf(const QByteArray& seed)
+    : m_seed(seed)
+    , m_accelerated(isAccelerated())
+{
+    Q_ASSERT(seed.size() == 32);
+
+    if (!m_accelerated) {
+        QByteArray iv(16, 0);
+        m_cipher1.reset(new SymmetricCipher(SymmetricCipher::Aes256, SymmetricCipher::Ecb,
+                                            SymmetricCipher::Encrypt, seed, iv));
+        m_cipher2.reset(new SymmetricCipher(SymmetricCipher::Aes256, SymmetricCipher::Ecb,
+                                            SymmetricCipher::Encrypt, seed, iv));
+    }
+}
+
+AesKdf::~AesKdf()
+{
+}
+
+void AesKdf::processInPlace(QByteArray& key, quint64 rounds)
+{
+    Q_ASSERT(key.size() == 32);
+
+#ifdef HAVE_AESNI
+    if (m_accelerated) {
+        AesKdfAesNi::transform(m_seed.constData(), key.data(), rounds);
+        return;
+    }
+#endif
+
+    QByteArray left = key.left(16);
+    QByteArray right = key.right(16);
+
+    QFuture<void> future = QtConcurrent::run(processHalf, m_cipher1.data(), &left, rounds);
+    processHalf(m_cipher2.data(), &right, rounds);
+    future.waitForFinished();
+
+    key = left + right;
+}
+
+bool AesKdf::isAccelerated()
+{
+#ifdef HAVE_AESNI
+    static const bool supported = AesKdfAesNi::isSupported();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void AesKdf::processHalf(SymmetricCipher* cipher, QByteArray* half, quint64 rounds)
+{
+    cipher->processInPlace(*half, rounds);
+}
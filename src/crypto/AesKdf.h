@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_AESKDF_H
+#define KEEPASSX_AESKDF_H
+
+#include <QByteArray>
+#include <QScopedPointer>
+
+#include "core/Global.h"
+
+class SymmetricCipher;
+
+/**
+ * The key transformation of KeePass 2 databases: both 16 byte halves of the
+ * key are encrypted with AES-256 in ECB mode using the transform seed as key.
+ *
+ * If the CPU supports AES-NI both halves are encrypted by a single kernel that
+ * interleaves them to hide the latency of the AES rounds. Otherwise each half
+ * is encrypted by libgcrypt on its own thread.
+ */
+class AesKdf
+{
+public:
+    explicit AesKdf(const QByteArray& seed);
+    ~AesKdf();
+    void processInPlace(QByteArray& key, quint64 rounds);
+
+    static bool isAccelerated();
+
+private:
+    static void processHalf(SymmetricCipher* cipher, QByteArray* half, quint64 rounds);
+
+    const QByteArray m_seed;
+    const bool m_accelerated;
+    QScopedPointer<SymmetricCipher> m_cipher1;
+    QScopedPointer<SymmetricCipher> m_cipher2;
+
+    Q_DISABLE_COPY(AesKdf)
+};
+
+#endif // KEEPASSX_AESKDF_H
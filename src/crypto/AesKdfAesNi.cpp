@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AesKdfAesNi.h"
+
+#include <cpuid.h>
+#include <wmmintrin.h>
+
+namespace {
+
+// AES-256 key expansion, see Intel's "Advanced Encryption Standard (AES) New Instructions Set"
+
+inline __m128i expandKeyEven(__m128i key1, __m128i assist)
+{
+    assist = _mm_shuffle_epi32(assist, 0xff);
+    __m128i tmp = _mm_slli_si128(key1, 0x4);
+    key1 = _mm_xor_si128(key1, tmp);
+    tmp = _mm_slli_si128(tmp, 0x4);
+    key1 = _mm_xor_si128(key1, tmp);
+    tmp = _mm_slli_si128(tmp, 0x4);
+    key1 = _mm_xor_si128(key1, tmp);
+    return _mm_xor_si128(key1, assist);
+}
+
+inline __m128i expandKeyOdd(__m128i key1, __m128i key2)
+{
+    __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key1, 0x00), 0xaa);
+    __m128i tmp = _mm_slli_si128(key2, 0x4);
+    key2 = _mm_xor_si128(key2, tmp);
+    tmp = _mm_slli_si128(tmp, 0x4);
+    key2 = _mm_xor_si128(key2, tmp);
+    tmp = _mm_slli_si128(tmp, 0x4);
+    key2 = _mm_xor_si128(key2, tmp);
+    return _mm_xor_si128(key2, assist);
+}
+
+void expandKey(const char* key, __m128i* schedule)
+{
+    schedule[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    schedule[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 16));
+
+    // _mm_aeskeygenassist_si128() needs the round constant as immediate value
+    schedule[2] = expandKeyEven(schedule[0], _mm_aeskeygenassist_si128(schedule[1], 0x01));
+    schedule[3] = expandKeyOdd(schedule[2], schedule[1]);
+    schedule[4] = expandKeyEven(schedule[2], _mm_aeskeygenassist_si128(schedule[3], 0x02));
+    schedule[5] = expandKeyOdd(schedule[4], schedule[3]);
+    schedule[6] = expandKeyEven(schedule[4], _mm_aeskeygenassist_si128(schedule[5], 0x04));
+    schedule[7] = expandKeyOdd(schedule[6], schedule[5]);
+    schedule[8] = expandKeyEven(schedule[6], _mm_aeskeygenassist_si128(schedule[7], 0x08));
+    schedule[9] = expandKeyOdd(schedule[8], schedule[7]);
+    schedule[10] = expandKeyEven(schedule[8], _mm_aeskeygenassist_si128(schedule[9], 0x10));
+    schedule[11] = expandKeyOdd(schedule[10], schedule[9]);
+    schedule[12] = expandKeyEven(schedule[10], _mm_aeskeygenassist_si128(schedule[11], 0x20));
+    schedule[13] = expandKeyOdd(schedule[12], schedule[11]);
+    schedule[14] = expandKeyEven(schedule[12], _mm_aeskeygenassist_si128(schedule[13], 0x40));
+}
+
+}
+
+bool AesKdfAesNi::isSupported()
+{
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+
+    return (ecx & bit_AES) != 0;
+}
+
+void AesKdfAesNi::transform(const char* key, char* data, quint64 rounds)
+{
+    __m128i schedule[15];
+    expandKey(key, schedule);
+
+    __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i block2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+
+    // The blocks are independent so the AES units can work on one
+    // while the result of the other one is still in flight.
+    for (quint64 i = 0; i < rounds; i++) {
+        block1 = _mm_xor_si128(block1, schedule[0]);
+        block2 = _mm_xor_si128(block2, schedule[0]);
+
+        for (int j = 1; j < 14; j++) {
+            block1 = _mm_aesenc_si128(block1, schedule[j]);
+            block2 = _mm_aesenc_si128(block2, schedule[j]);
+        }
+
+        block1 = _mm_aesenclast_si128(block1, schedule[14]);
+        block2 = _mm_aesenclast_si128(block2, schedule[14]);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), block1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + 16), block2);
+}
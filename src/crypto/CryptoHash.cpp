@@ -63,14 +63,19 @@ CryptoHash::~CryptoHash()
 }
 
 void CryptoHash::addData(const QByteArray& data)
+{
+    addData(data.constData(), data.size());
+}
+
+void CryptoHash::addData(const char* data, int size)
 {
     Q_D(CryptoHash);
 
-    if (data.isEmpty()) {
+    if (size <= 0) {
         return;
     }
 
-    gcry_md_write(d->ctx, data.constData(), data.size());
+    gcry_md_write(d->ctx, data, size);
 }
 
 void CryptoHash::reset()
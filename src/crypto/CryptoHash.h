@@ -33,6 +33,7 @@ public:
     explicit CryptoHash(CryptoHash::Algorithm algo);
     ~CryptoHash();
     void addData(const QByteArray& data);
+    void addData(const char* data, int size);
     void reset();
     QByteArray result() const;
 
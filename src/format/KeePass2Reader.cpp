@@ -20,6 +20,7 @@
 #include <QBuffer>
 #include <QFile>
 #include <QIODevice>
+#include <QThread>
 
 #include "core/Database.h"
 #include "core/Endian.h"
@@ -27,6 +28,7 @@
 #include "format/KeePass2.h"
 #include "format/KeePass2RandomStream.h"
 #include "format/KeePass2XmlReader.h"
+#include "streams/BlockQueueStream.h"
 #include "streams/HashedBlockStream.h"
 #include "streams/QtIOCompressor"
 #include "streams/StoreDataStream.h"
@@ -35,6 +37,8 @@
 KeePass2Reader::KeePass2Reader()
     : m_error(false)
     , m_saveXml(false)
+    , m_pipelined(true)
+    , m_transformedKeyRounds(0)
 {
 }
 
@@ -43,44 +47,12 @@ Database* KeePass2Reader::readDatabase(QIODevice* device, const CompositeKey& ke
     QScopedPointer<Database> db(new Database());
     m_db = db.data();
     m_device = device;
-    m_error = false;
-    m_errorStr.clear();
-    m_headerEnd = false;
-    m_xmlData.clear();
-    m_masterSeed.clear();
-    m_transformSeed.clear();
-    m_encryptionIV.clear();
-    m_streamStartBytes.clear();
-    m_protectedStreamKey.clear();
 
     StoreDataStream headerStream(m_device);
     headerStream.open(QIODevice::ReadOnly);
     m_headerStream = &headerStream;
 
-    bool ok;
-
-    quint32 signature1 = Endian::readUInt32(m_headerStream, KeePass2::BYTEORDER, &ok);
-    if (!ok || signature1 != KeePass2::SIGNATURE_1) {
-        raiseError(tr("Not a KeePass database."));
-        return Q_NULLPTR;
-    }
-
-    quint32 signature2 = Endian::readUInt32(m_headerStream, KeePass2::BYTEORDER, &ok);
-    if (!ok || signature2 != KeePass2::SIGNATURE_2) {
-        raiseError(tr("Not a KeePass database."));
-        return Q_NULLPTR;
-    }
-
-    quint32 version = Endian::readUInt32(m_headerStream, KeePass2::BYTEORDER, &ok)
-            & KeePass2::FILE_VERSION_CRITICAL_MASK;
-    quint32 maxVersion = KeePass2::FILE_VERSION & KeePass2::FILE_VERSION_CRITICAL_MASK;
-    if (!ok || (version < KeePass2::FILE_VERSION_MIN) || (version > maxVersion)) {
-        raiseError(tr("Unsupported KeePass database version."));
-        return Q_NULLPTR;
-    }
-
-    while (readHeaderField() && !hasError()) {
-    }
+    quint32 version = readHeader();
 
     headerStream.close();
 
@@ -88,15 +60,13 @@ Database* KeePass2Reader::readDatabase(QIODevice* device, const CompositeKey& ke
         return Q_NULLPTR;
     }
 
-    // check if all required headers were present
-    if (m_masterSeed.isEmpty() || m_transformSeed.isEmpty() || m_encryptionIV.isEmpty()
-            || m_streamStartBytes.isEmpty() || m_protectedStreamKey.isEmpty()
-            || m_db->cipher().isNull()) {
-        raiseError("missing database headers");
-        return Q_NULLPTR;
+    if (!m_transformedKey.isEmpty() && m_transformedKeySeed == m_transformSeed
+            && m_transformedKeyRounds == m_db->transformRounds()) {
+        m_db->setKey(key, m_transformSeed, m_transformedKeyRounds, m_transformedKey, false);
+    }
+    else {
+        m_db->setKey(key, m_transformSeed, false);
     }
-
-    m_db->setKey(key, m_transformSeed, false);
 
     if (m_db->challengeMasterSeed(m_masterSeed) == false) {
         raiseError(tr("Unable to issue challenge-response."));
@@ -110,7 +80,8 @@ Database* KeePass2Reader::readDatabase(QIODevice* device, const CompositeKey& ke
     QByteArray finalKey = hash.result();
 
     SymmetricCipherStream cipherStream(m_device, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
-                                       SymmetricCipher::Decrypt, finalKey, m_encryptionIV);
+                                       SymmetricCipher::Decrypt, finalKey, m_encryptionIV,
+                                       SymmetricCipherStream::BulkChunkSize);
     cipherStream.open(QIODevice::ReadOnly);
 
     QByteArray realStart = cipherStream.read(32);
@@ -120,36 +91,16 @@ Database* KeePass2Reader::readDatabase(QIODevice* device, const CompositeKey& ke
         return Q_NULLPTR;
     }
 
-    HashedBlockStream hashedStream(&cipherStream);
-    hashedStream.open(QIODevice::ReadOnly);
-
-    QIODevice* xmlDevice;
-    QScopedPointer<QtIOCompressor> ioCompressor;
+    KeePass2RandomStream randomStream(m_protectedStreamKey);
+    KeePass2XmlReader xmlReader;
 
-    if (m_db->compressionAlgo() == Database::CompressionNone) {
-        xmlDevice = &hashedStream;
+    if (m_pipelined) {
+        readXmlPipelined(&cipherStream, &xmlReader, &randomStream);
     }
     else {
-        ioCompressor.reset(new QtIOCompressor(&hashedStream));
-        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
-        ioCompressor->open(QIODevice::ReadOnly);
-        xmlDevice = ioCompressor.data();
+        readXml(&cipherStream, &xmlReader, &randomStream);
     }
 
-    KeePass2RandomStream randomStream(m_protectedStreamKey);
-
-    QScopedPointer<QBuffer> buffer;
-
-    if (m_saveXml) {
-        m_xmlData = xmlDevice->readAll();
-        buffer.reset(new QBuffer(&m_xmlData));
-        buffer->open(QIODevice::ReadOnly);
-        xmlDevice = buffer.data();
-    }
-
-    KeePass2XmlReader xmlReader;
-    xmlReader.readDatabase(xmlDevice, m_db, &randomStream);
-
     if (xmlReader.hasError()) {
         raiseError(xmlReader.errorString());
         return Q_NULLPTR;
@@ -168,6 +119,87 @@ Database* KeePass2Reader::readDatabase(QIODevice* device, const CompositeKey& ke
     return db.take();
 }
 
+bool KeePass2Reader::readTransformParameters(QIODevice* device, QByteArray* transformSeed,
+                                             quint64* transformRounds)
+{
+    Database db;
+    m_db = &db;
+    m_device = device;
+    m_headerStream = device;
+
+    readHeader();
+
+    m_db = Q_NULLPTR;
+
+    if (hasError()) {
+        return false;
+    }
+
+    *transformSeed = m_transformSeed;
+    *transformRounds = db.transformRounds();
+    return true;
+}
+
+void KeePass2Reader::setTransformedKey(const QByteArray& transformSeed, quint64 transformRounds,
+                                       const QByteArray& transformedKey)
+{
+    m_transformedKeySeed = transformSeed;
+    m_transformedKeyRounds = transformRounds;
+    m_transformedKey = transformedKey;
+}
+
+quint32 KeePass2Reader::readHeader()
+{
+    m_error = false;
+    m_errorStr.clear();
+    m_headerEnd = false;
+    m_xmlData.clear();
+    m_masterSeed.clear();
+    m_transformSeed.clear();
+    m_encryptionIV.clear();
+    m_streamStartBytes.clear();
+    m_protectedStreamKey.clear();
+
+    bool ok;
+
+    quint32 signature1 = Endian::readUInt32(m_headerStream, KeePass2::BYTEORDER, &ok);
+    if (!ok || signature1 != KeePass2::SIGNATURE_1) {
+        raiseError(tr("Not a KeePass database."));
+        return 0;
+    }
+
+    quint32 signature2 = Endian::readUInt32(m_headerStream, KeePass2::BYTEORDER, &ok);
+    if (!ok || signature2 != KeePass2::SIGNATURE_2) {
+        raiseError(tr("Not a KeePass database."));
+        return 0;
+    }
+
+    quint32 version = Endian::readUInt32(m_headerStream, KeePass2::BYTEORDER, &ok)
+            & KeePass2::FILE_VERSION_CRITICAL_MASK;
+    quint32 maxVersion = KeePass2::FILE_VERSION & KeePass2::FILE_VERSION_CRITICAL_MASK;
+    if (!ok || (version < KeePass2::FILE_VERSION_MIN) || (version > maxVersion)) {
+        raiseError(tr("Unsupported KeePass database version."));
+        return 0;
+    }
+
+    while (readHeaderField() && !hasError()) {
+    }
+
+    if (hasError()) {
+        return 0;
+    }
+
+    // check if all required headers were present
+    if (m_masterSeed.isEmpty() || m_transformSeed.isEmpty() || m_encryptionIV.isEmpty()
+            || m_streamStartBytes.isEmpty() || m_protectedStreamKey.isEmpty()
+            || m_db->cipher().isNull()) {
+        raiseError("missing database headers");
+        return 0;
+    }
+
+    return version;
+}
+
 Database* KeePass2Reader::readDatabase(const QString& filename, const CompositeKey& key)
 {
     QFile file(filename);
@@ -212,6 +244,110 @@ void KeePass2Reader::raiseError(const QString& errorMessage)
     m_errorStr = errorMessage;
 }
 
+void KeePass2Reader::setPipelined(bool pipelined)
+{
+    m_pipelined = pipelined;
+}
+
+void KeePass2Reader::readXml(QIODevice* payloadDevice, KeePass2XmlReader* xmlReader,
+                             KeePass2RandomStream* randomStream)
+{
+    HashedBlockStream hashedStream(payloadDevice);
+    hashedStream.setConcurrentBlocks(qMax(QThread::idealThreadCount(), 1));
+    hashedStream.open(QIODevice::ReadOnly);
+
+    QIODevice* xmlDevice;
+    QScopedPointer<QtIOCompressor> ioCompressor;
+
+    if (m_db->compressionAlgo() == Database::CompressionNone) {
+        xmlDevice = &hashedStream;
+    }
+    else {
+        ioCompressor.reset(new QtIOCompressor(&hashedStream));
+        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor->open(QIODevice::ReadOnly);
+        xmlDevice = ioCompressor.data();
+    }
+
+    QScopedPointer<QBuffer> buffer;
+
+    if (m_saveXml) {
+        m_xmlData = xmlDevice->readAll();
+        buffer.reset(new QBuffer(&m_xmlData));
+        buffer->open(QIODevice::ReadOnly);
+        xmlDevice = buffer.data();
+    }
+
+    xmlReader->readDatabase(xmlDevice, m_db, randomStream);
+}
+
+void KeePass2Reader::readXmlPipelined(QIODevice* payloadDevice, KeePass2XmlReader* xmlReader,
+                                      KeePass2RandomStream* randomStream)
+{
+    // Decryption, block verification and decompression each run on their own
+    // thread while the xml is parsed on this one.
+    // The stages are connected by bounded queues to limit the memory usage.
+    const int queueDepth = 4;
+    const int chunkSize = 1024 * 1024;
+
+    BlockQueueStream decryptedQueue(queueDepth);
+    decryptedQueue.open(QIODevice::ReadOnly);
+    BlockQueueFeeder decryptThread(payloadDevice, &decryptedQueue, SymmetricCipherStream::BulkChunkSize);
+
+    HashedBlockStream hashedStream(&decryptedQueue);
+    hashedStream.setConcurrentBlocks(qMax(QThread::idealThreadCount(), 1));
+    hashedStream.open(QIODevice::ReadOnly);
+    BlockQueueStream verifiedQueue(queueDepth);
+    verifiedQueue.open(QIODevice::ReadOnly);
+    BlockQueueFeeder verifyThread(&hashedStream, &verifiedQueue, chunkSize);
+
+    QIODevice* xmlDevice = &verifiedQueue;
+    QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<BlockQueueStream> inflatedQueue;
+    QScopedPointer<BlockQueueFeeder> inflateThread;
+
+    if (m_db->compressionAlgo() != Database::CompressionNone) {
+        ioCompressor.reset(new QtIOCompressor(&verifiedQueue));
+        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor->open(QIODevice::ReadOnly);
+        inflatedQueue.reset(new BlockQueueStream(queueDepth));
+        inflatedQueue->open(QIODevice::ReadOnly);
+        inflateThread.reset(new BlockQueueFeeder(ioCompressor.data(), inflatedQueue.data(), chunkSize));
+        xmlDevice = inflatedQueue.data();
+    }
+
+    decryptThread.start();
+    verifyThread.start();
+    if (inflateThread) {
+        inflateThread->start();
+    }
+
+    QScopedPointer<QBuffer> buffer;
+
+    if (m_saveXml) {
+        m_xmlData = xmlDevice->readAll();
+        buffer.reset(new QBuffer(&m_xmlData));
+        buffer->open(QIODevice::ReadOnly);
+        xmlDevice = buffer.data();
+    }
+
+    xmlReader->readDatabase(xmlDevice, m_db, randomStream);
+
+    // The xml reader doesn't necessarily consume all data (e.g. on errors),
+    // make sure the stages don't wait for it.
+    decryptedQueue.abort();
+    verifiedQueue.abort();
+    if (inflatedQueue) {
+        inflatedQueue->abort();
+    }
+
+    decryptThread.wait();
+    verifyThread.wait();
+    if (inflateThread) {
+        inflateThread->wait();
+    }
+}
+
 bool KeePass2Reader::readHeaderField()
 {
     QByteArray fieldIDArray = m_headerStream->read(1);
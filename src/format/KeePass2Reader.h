@@ -23,6 +23,8 @@
 #include "keys/CompositeKey.h"
 
 class Database;
+class KeePass2RandomStream;
+class KeePass2XmlReader;
 class QIODevice;
 
 class KeePass2Reader
@@ -37,10 +39,28 @@ public:
     QString errorString();
     void setSaveXml(bool save);
     QByteArray xmlData();
+    void setPipelined(bool pipelined);
+
+    /**
+     * Reads just the header of the database to find out how its key is transformed.
+     */
+    bool readTransformParameters(QIODevice* device, QByteArray* transformSeed, quint64* transformRounds);
+
+    /**
+     * Makes readDatabase() use transformedKey instead of transforming the key itself
+     * when the database header matches transformSeed and transformRounds.
+     */
+    void setTransformedKey(const QByteArray& transformSeed, quint64 transformRounds,
+                           const QByteArray& transformedKey);
 
 private:
     void raiseError(const QString& errorMessage);
 
+    void readXml(QIODevice* payloadDevice, KeePass2XmlReader* xmlReader, KeePass2RandomStream* randomStream);
+    void readXmlPipelined(QIODevice* payloadDevice, KeePass2XmlReader* xmlReader,
+                          KeePass2RandomStream* randomStream);
+
+    quint32 readHeader();
     bool readHeaderField();
 
     void setCipher(const QByteArray& data);
@@ -59,6 +79,7 @@ private:
     QString m_errorStr;
     bool m_headerEnd;
     bool m_saveXml;
+    bool m_pipelined;
     QByteArray m_xmlData;
 
     Database* m_db;
@@ -67,6 +88,9 @@ private:
     QByteArray m_encryptionIV;
     QByteArray m_streamStartBytes;
     QByteArray m_protectedStreamKey;
+    QByteArray m_transformedKeySeed;
+    quint64 m_transformedKeyRounds;
+    QByteArray m_transformedKey;
 };
 
 #endif // KEEPASSX_KEEPASS2READER_H
@@ -20,6 +20,7 @@
 #include <QBuffer>
 #include <QFile>
 #include <QIODevice>
+#include <QThread>
 
 #include "core/Database.h"
 #include "core/Endian.h"
@@ -97,12 +98,14 @@ bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
     CHECK_RETURN_FALSE(writeData(header.data()));
 
     SymmetricCipherStream cipherStream(device, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
-                                       SymmetricCipher::Encrypt, finalKey, encryptionIV);
+                                       SymmetricCipher::Encrypt, finalKey, encryptionIV,
+                                       SymmetricCipherStream::BulkChunkSize);
     cipherStream.open(QIODevice::WriteOnly);
     m_device = &cipherStream;
     CHECK_RETURN_FALSE(writeData(startBytes));
 
     HashedBlockStream hashedStream(&cipherStream);
+    hashedStream.setConcurrentBlocks(qMax(QThread::idealThreadCount(), 1));
     hashedStream.open(QIODevice::WriteOnly);
 
     QScopedPointer<QtIOCompressor> ioCompressor;
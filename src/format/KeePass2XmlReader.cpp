@@ -17,7 +17,6 @@
 
 #include "KeePass2XmlReader.h"
 
-#include <QBuffer>
 #include <QFile>
 
 #include "core/Database.h"
@@ -26,7 +25,7 @@
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "format/KeePass2RandomStream.h"
-#include "streams/QtIOCompressor"
+#include "format/KeePass2XmlReader_p.h"
 
 typedef QPair<QString, QString> StringPair;
 
@@ -106,6 +105,13 @@ void KeePass2XmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Ra
         target.first->attachments()->set(target.second, m_binaryPool[i.key()]);
     }
 
+    QList<QPair<Entry*, Entry*> >::const_iterator iHistory;
+    for (iHistory = m_historyItems.constBegin(); iHistory != m_historyItems.constEnd(); ++iHistory) {
+        iHistory->first->addHistoryItem(iHistory->second->snapshot());
+        delete iHistory->second;
+    }
+    m_historyItems.clear();
+
     m_meta->setUpdateDatetime(true);
 
     QHash<Uuid, Group*>::const_iterator iGroup;
@@ -116,10 +122,6 @@ void KeePass2XmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Ra
     QHash<Uuid, Entry*>::const_iterator iEntry;
     for (iEntry = m_entries.constBegin(); iEntry != m_entries.constEnd(); ++iEntry) {
         iEntry.value()->setUpdateTimeinfo(true);
-
-        Q_FOREACH (Entry* histEntry, iEntry.value()->historyItems()) {
-            histEntry->setUpdateTimeinfo(true);
-        }
     }
 
     delete m_tmpParent;
@@ -775,7 +777,7 @@ Entry* KeePass2XmlReader::parseEntry(bool history)
     }
 
     Q_FOREACH (Entry* historyItem, historyItems) {
-        entry->addHistoryItem(historyItem);
+        m_historyItems.append(qMakePair(entry, historyItem));
     }
 
     Q_FOREACH (const StringPair& ref, binaryRefs) {
@@ -1105,25 +1107,49 @@ Uuid KeePass2XmlReader::readUuid()
 
 QByteArray KeePass2XmlReader::readBinary()
 {
-    return QByteArray::fromBase64(readString().toLatin1());
+    XmlBinaryDecoder decoder(false);
+    readBinaryText(&decoder);
+    return decoder.data();
 }
 
 QByteArray KeePass2XmlReader::readCompressedBinary()
 {
-    QByteArray rawData = readBinary();
-
-    QBuffer buffer(&rawData);
-    buffer.open(QIODevice::ReadOnly);
-
-    QtIOCompressor compressor(&buffer);
-    compressor.setStreamFormat(QtIOCompressor::GzipFormat);
-    compressor.open(QIODevice::ReadOnly);
-
-    QByteArray result;
-    if (!Tools::readAllFromDevice(&compressor, result)) {
+    XmlBinaryDecoder decoder(true);
+    if (!readBinaryText(&decoder) && !m_error && !m_xml.hasError()) {
         raiseError("Unable to decompress binary");
     }
-    return result;
+    return decoder.data();
+}
+
+bool KeePass2XmlReader::readBinaryText(XmlBinaryDecoder* decoder)
+{
+    Q_ASSERT(m_xml.isStartElement());
+
+    // same as QXmlStreamReader::readElementText() but hands every chunk of
+    // character data to the decoder instead of concatenating it
+    while (!m_xml.atEnd()) {
+        switch (m_xml.readNext()) {
+        case QXmlStreamReader::Characters:
+        case QXmlStreamReader::EntityReference:
+            if (!decoder->addText(m_xml.text())) {
+                m_xml.skipCurrentElement();
+                return false;
+            }
+            break;
+        case QXmlStreamReader::EndElement:
+            return decoder->finish();
+        case QXmlStreamReader::Comment:
+        case QXmlStreamReader::ProcessingInstruction:
+            break;
+        case QXmlStreamReader::StartElement:
+            m_xml.raiseError("Expected character data.");
+            return false;
+        default:
+            return false;
+        }
+    }
+
+    return false;
 }
 
 Group* KeePass2XmlReader::getGroup(const Uuid& uuid)
@@ -1169,3 +1195,151 @@ void KeePass2XmlReader::skipCurrentElement()
     qWarning("KeePass2XmlReader::skipCurrentElement: skip element \"%s\"", qPrintable(m_xml.name().toString()));
     m_xml.skipCurrentElement();
 }
+
+XmlBinaryDecoder::XmlBinaryDecoder(bool compressed)
+    : m_compressed(compressed)
+    , m_zstreamInitialized(false)
+    , m_zstreamEnd(false)
+    , m_bits(0)
+    , m_bitCount(0)
+    , m_reserved(false)
+{
+    if (m_compressed) {
+        m_zstream.zalloc = Z_NULL;
+        m_zstream.zfree = Z_NULL;
+        m_zstream.opaque = Z_NULL;
+        m_zstream.next_in = Z_NULL;
+        m_zstream.avail_in = 0;
+        // 16 selects the gzip format
+        m_zstreamInitialized = (inflateInit2(&m_zstream, MAX_WBITS + 16) == Z_OK);
+    }
+}
+
+XmlBinaryDecoder::~XmlBinaryDecoder()
+{
+    if (m_zstreamInitialized) {
+        inflateEnd(&m_zstream);
+    }
+}
+
+bool XmlBinaryDecoder::addText(const QStringRef& text)
+{
+    const QChar* chars = text.unicode();
+    const int size = text.size();
+
+    // QXmlStreamReader reports the text of an element as a single chunk
+    // unless it contains entity references, so the first chunk gives the
+    // size of the output. Further chunks use the growth of QByteArray.
+    if (!m_compressed && !m_reserved) {
+        m_data.reserve((size / 4) * 3 + 3);
+        m_reserved = true;
+    }
+
+    char buffer[4096];
+    int bufferSize = 0;
+
+    // decodes like QByteArray::fromBase64(): characters outside of the
+    // alphabet (whitespace, padding) are skipped
+    for (int i = 0; i < size; i++) {
+        ushort ch = chars[i].unicode();
+        int value;
+
+        if (ch >= 'A' && ch <= 'Z') {
+            value = ch - 'A';
+        }
+        else if (ch >= 'a' && ch <= 'z') {
+            value = ch - 'a' + 26;
+        }
+        else if (ch >= '0' && ch <= '9') {
+            value = ch - '0' + 52;
+        }
+        else if (ch == '+') {
+            value = 62;
+        }
+        else if (ch == '/') {
+            value = 63;
+        }
+        else {
+            continue;
+        }
+
+        m_bits = (m_bits << 6) | static_cast<quint32>(value);
+        m_bitCount += 6;
+
+        if (m_bitCount >= 8) {
+            m_bitCount -= 8;
+            buffer[bufferSize++] = static_cast<char>(m_bits >> m_bitCount);
+            m_bits &= (1u << m_bitCount) - 1;
+
+            if (bufferSize == static_cast<int>(sizeof(buffer))) {
+                if (!writeDecoded(buffer, bufferSize)) {
+                    return false;
+                }
+                bufferSize = 0;
+            }
+        }
+    }
+
+    return writeDecoded(buffer, bufferSize);
+}
+
+bool XmlBinaryDecoder::finish()
+{
+    // an empty payload decodes to empty data, only a started stream
+    // has to be complete
+    if (m_compressed && !m_zstreamEnd && m_zstreamInitialized && m_zstream.total_in > 0) {
+        return false;
+    }
+
+    m_data.squeeze();
+    return true;
+}
+
+QByteArray XmlBinaryDecoder::data() const
+{
+    return m_data;
+}
+
+bool XmlBinaryDecoder::writeDecoded(const char* data, int size)
+{
+    if (!m_compressed) {
+        m_data.append(data, size);
+        return true;
+    }
+
+    if (!m_zstreamInitialized) {
+        return false;
+    }
+
+    // ignore trailing garbage after the end of the gzip stream
+    if (m_zstreamEnd || size == 0) {
+        return true;
+    }
+
+    m_zstream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    m_zstream.avail_in = static_cast<uInt>(size);
+
+    char buffer[16384];
+
+    do {
+        m_zstream.next_out = reinterpret_cast<Bytef*>(buffer);
+        m_zstream.avail_out = sizeof(buffer);
+
+        int result = inflate(&m_zstream, Z_NO_FLUSH);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+            return false;
+        }
+
+        m_data.append(buffer, static_cast<int>(sizeof(buffer) - m_zstream.avail_out));
+
+        if (result == Z_STREAM_END) {
+            m_zstreamEnd = true;
+            break;
+        }
+        if (result == Z_BUF_ERROR && m_zstream.avail_out != 0) {
+            break;
+        }
+    } while (m_zstream.avail_in > 0 || m_zstream.avail_out == 0);
+
+    return true;
+}
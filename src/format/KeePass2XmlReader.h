@@ -34,6 +34,7 @@ class Entry;
 class Group;
 class KeePass2RandomStream;
 class Metadata;
+class XmlBinaryDecoder;
 
 class KeePass2XmlReader
 {
@@ -78,6 +79,7 @@ private:
     Uuid readUuid();
     QByteArray readBinary();
     QByteArray readCompressedBinary();
+    bool readBinaryText(XmlBinaryDecoder* decoder);
 
     Group* getGroup(const Uuid& uuid);
     Entry* getEntry(const Uuid& uuid);
@@ -93,6 +95,8 @@ private:
     QHash<Uuid, Entry*> m_entries;
     QHash<QString, QByteArray> m_binaryPool;
     QHash<QString, QPair<Entry*, QString> > m_binaryMap;
+    // history items are added as snapshots once their attachments are known
+    QList<QPair<Entry*, Entry*> > m_historyItems;
     QByteArray m_headerHash;
     bool m_error;
     QString m_errorStr;
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_KEEPASS2XMLREADER_P_H
+#define KEEPASSX_KEEPASS2XMLREADER_P_H
+
+#include <QByteArray>
+
+#include <zlib.h>
+
+class QStringRef;
+
+/**
+ * Decodes base64 character data chunk by chunk and optionally gunzips it,
+ * appending the output directly to the result buffer.
+ */
+class XmlBinaryDecoder
+{
+public:
+    explicit XmlBinaryDecoder(bool compressed);
+    ~XmlBinaryDecoder();
+    bool addText(const QStringRef& text);
+    bool finish();
+    QByteArray data() const;
+
+private:
+    bool writeDecoded(const char* data, int size);
+
+    const bool m_compressed;
+    bool m_zstreamInitialized;
+    bool m_zstreamEnd;
+    z_stream m_zstream;
+    quint32 m_bits;
+    int m_bitCount;
+    bool m_reserved;
+    QByteArray m_data;
+
+    Q_DISABLE_COPY(XmlBinaryDecoder)
+};
+
+#endif // KEEPASSX_KEEPASS2XMLREADER_P_H
@@ -16,11 +16,14 @@
  */
 
 #include "KeePass2XmlWriter.h"
+#include "KeePass2XmlWriter_p.h"
 
-#include <QBuffer>
 #include <QFile>
+#include <QScopedPointer>
 
+#include "core/AttachmentPool.h"
 #include "core/Metadata.h"
+#include "core/TreeIterator.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/QtIOCompressor"
 
@@ -67,14 +70,22 @@ void KeePass2XmlWriter::writeDatabase(const QString& filename, Database* db)
 
 void KeePass2XmlWriter::generateIdMap()
 {
-    QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
     int nextId = 0;
 
-    Q_FOREACH (Entry* entry, allEntries) {
-        Q_FOREACH (const QString& key, entry->attachments()->keys()) {
-            QByteArray data = entry->attachments()->value(key);
-            if (!m_idMap.contains(data)) {
-                m_idMap.insert(data, nextId++);
+    EntryIterator i(m_db->rootGroup());
+    while (i.hasNext()) {
+        const Entry* entry = i.next();
+        Q_FOREACH (int poolKey, entry->attachments()->poolKeys()) {
+            if (!m_idMap.contains(poolKey)) {
+                m_idMap.insert(poolKey, nextId++);
+            }
+        }
+
+        Q_FOREACH (const EntrySnapshot& historyItem, entry->historySnapshots()) {
+            Q_FOREACH (int poolKey, historyItem.attachments) {
+                if (!m_idMap.contains(poolKey)) {
+                    m_idMap.insert(poolKey, nextId++);
+                }
             }
         }
     }
@@ -147,13 +158,13 @@ void KeePass2XmlWriter::writeIcon(const Uuid& uuid, const QImage& icon)
 
     writeUuid("UUID", uuid);
 
-    QByteArray ba;
-    QBuffer buffer(&ba);
-    buffer.open(QIODevice::WriteOnly);
+    m_xml.writeStartElement("Data");
+    XmlBase64Stream stream(&m_xml);
+    stream.open(QIODevice::WriteOnly);
     // TODO: check !icon.save()
-    icon.save(&buffer, "PNG");
-    buffer.close();
-    writeBinary("Data", ba);
+    icon.save(&stream, "PNG");
+    stream.close();
+    m_xml.writeEndElement();
 
     m_xml.writeEndElement();
 }
@@ -162,38 +173,39 @@ void KeePass2XmlWriter::writeBinaries()
 {
     m_xml.writeStartElement("Binaries");
 
-    QHash<QByteArray, int>::const_iterator i;
+    QHash<int, int>::const_iterator i;
     for (i = m_idMap.constBegin(); i != m_idMap.constEnd(); ++i) {
+        QByteArray data = attachmentPool()->data(i.key());
+
         m_xml.writeStartElement("Binary");
 
         m_xml.writeAttribute("ID", QString::number(i.value()));
 
-        QByteArray data;
-        if (m_db->compressionAlgo() == Database::CompressionGZip) {
+        bool compressed = (m_db->compressionAlgo() == Database::CompressionGZip);
+        if (compressed) {
             m_xml.writeAttribute("Compressed", "True");
+        }
 
-            QBuffer buffer;
-            buffer.open(QIODevice::ReadWrite);
+        // compress and encode the data in chunks so there is never
+        // a complete copy of it in memory
+        XmlBase64Stream stream(&m_xml);
+        stream.open(QIODevice::WriteOnly);
 
-            QtIOCompressor compressor(&buffer);
+        if (compressed) {
+            QtIOCompressor compressor(&stream);
             compressor.setStreamFormat(QtIOCompressor::GzipFormat);
             compressor.open(QIODevice::WriteOnly);
 
-            qint64 bytesWritten = compressor.write(i.key());
-            Q_ASSERT(bytesWritten == i.key().size());
+            qint64 bytesWritten = compressor.write(data);
+            Q_ASSERT(bytesWritten == data.size());
             Q_UNUSED(bytesWritten);
             compressor.close();
-
-            buffer.seek(0);
-            data = buffer.readAll();
         }
         else {
-            data = i.key();
+            stream.write(data);
         }
 
-        if (!data.isEmpty()) {
-            m_xml.writeCharacters(QString::fromLatin1(data.toBase64()));
-        }
+        stream.close();
         m_xml.writeEndElement();
     }
 
@@ -366,7 +378,7 @@ void KeePass2XmlWriter::writeEntry(const Entry* entry)
         writeString("Key", key);
 
         m_xml.writeStartElement("Value");
-        m_xml.writeAttribute("Ref", QString::number(m_idMap[entry->attachments()->value(key)]));
+        m_xml.writeAttribute("Ref", QString::number(m_idMap[entry->attachments()->poolKey(key)]));
         m_xml.writeEndElement();
 
         m_xml.writeEndElement();
@@ -410,9 +422,11 @@ void KeePass2XmlWriter::writeEntryHistory(const Entry* entry)
 {
     m_xml.writeStartElement("History");
 
-    const QList<Entry*>& historyItems = entry->historyItems();
-    Q_FOREACH (const Entry* item, historyItems) {
-        writeEntry(item);
+    // write temporary entries instead of historyItems() which keeps
+    // the entries of all history items around
+    Q_FOREACH (const EntrySnapshot& historyItem, entry->historySnapshots()) {
+        QScopedPointer<Entry> item(Entry::fromSnapshot(historyItem));
+        writeEntry(item.data());
     }
 
     m_xml.writeEndElement();
@@ -527,3 +541,62 @@ QString KeePass2XmlWriter::colorPartToString(int value)
 
     return str;
 }
+
+const int XmlBase64Stream::ChunkSize = 3 * 16384;
+
+XmlBase64Stream::XmlBase64Stream(QXmlStreamWriter* xml)
+    : m_xml(xml)
+{
+}
+
+XmlBase64Stream::~XmlBase64Stream()
+{
+    close();
+}
+
+bool XmlBase64Stream::isSequential() const
+{
+    return true;
+}
+
+void XmlBase64Stream::close()
+{
+    if (isOpen()) {
+        writeBuffer();
+    }
+
+    QIODevice::close();
+}
+
+qint64 XmlBase64Stream::readData(char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+
+    return -1;
+}
+
+qint64 XmlBase64Stream::writeData(const char* data, qint64 maxSize)
+{
+    qint64 offset = 0;
+
+    while (offset < maxSize) {
+        int size = static_cast<int>(qMin(maxSize - offset, static_cast<qint64>(ChunkSize - m_buffer.size())));
+        m_buffer.append(data + offset, size);
+        offset += size;
+
+        if (m_buffer.size() == ChunkSize) {
+            writeBuffer();
+        }
+    }
+
+    return maxSize;
+}
+
+void XmlBase64Stream::writeBuffer()
+{
+    if (!m_buffer.isEmpty()) {
+        m_xml->writeCharacters(QString::fromLatin1(m_buffer.toBase64()));
+        m_buffer.clear();
+    }
+}
@@ -79,7 +79,7 @@ private:
     Metadata* m_meta;
     KeePass2RandomStream* m_randomStream;
     QByteArray m_headerHash;
-    QHash<QByteArray, int> m_idMap;
+    QHash<int, int> m_idMap;
 };
 
 #endif // KEEPASSX_KEEPASS2XMLWRITER_H
@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_KEEPASS2XMLWRITER_P_H
+#define KEEPASSX_KEEPASS2XMLWRITER_P_H
+
+#include <QIODevice>
+
+#include "core/Global.h"
+
+class QXmlStreamWriter;
+
+/**
+ * Writes the base64 encoding of everything written to it as character data
+ * of the current element, one fixed-size chunk at a time.
+ */
+class XmlBase64Stream : public QIODevice
+{
+public:
+    explicit XmlBase64Stream(QXmlStreamWriter* xml);
+    ~XmlBase64Stream();
+    bool isSequential() const Q_DECL_OVERRIDE;
+    void close() Q_DECL_OVERRIDE;
+
+    // multiple of 3 so the chunks don't need padding
+    static const int ChunkSize;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) Q_DECL_OVERRIDE;
+    qint64 writeData(const char* data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private:
+    void writeBuffer();
+
+    QXmlStreamWriter* const m_xml;
+    QByteArray m_buffer;
+};
+
+#endif // KEEPASSX_KEEPASS2XMLWRITER_P_H
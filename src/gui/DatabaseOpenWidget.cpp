@@ -24,10 +24,13 @@
 #include "core/Database.h"
 #include "core/FilePath.h"
 #include "gui/FileDialog.h"
+#include "gui/KeyTransformDialog.h"
 #include "gui/MessageBox.h"
 #include "format/KeePass2Reader.h"
 #include "keys/FileKey.h"
+#include "keys/KeyTransformer.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 #include "keys/YkChallengeResponseKey.h"
 #include "crypto/Random.h"
 
@@ -36,6 +39,7 @@ DatabaseOpenWidget::DatabaseOpenWidget(QWidget* parent)
     : DialogyWidget(parent)
     , m_ui(new Ui::DatabaseOpenWidget())
     , m_db(Q_NULLPTR)
+    , m_keyTransformer(new KeyTransformer(this))
 {
     m_ui->setupUi(this);
 
@@ -63,6 +67,8 @@ DatabaseOpenWidget::DatabaseOpenWidget(QWidget* parent)
 
     connect(m_ui->buttonBox, SIGNAL(accepted()), SLOT(openDatabase()));
     connect(m_ui->buttonBox, SIGNAL(rejected()), SLOT(reject()));
+
+    connect(m_keyTransformer, SIGNAL(finished()), SLOT(keyTransformFinished()));
 }
 
 DatabaseOpenWidget::~DatabaseOpenWidget()
@@ -109,6 +115,10 @@ void DatabaseOpenWidget::enterKey(const QString& pw, const QString& keyFile)
 
 void DatabaseOpenWidget::openDatabase()
 {
+    if (m_keyTransformer->isRunning()) {
+        return;
+    }
+
     KeePass2Reader reader;
     CompositeKey masterKey = databaseKey();
     if (masterKey.isEmpty()) {
@@ -117,14 +127,56 @@ void DatabaseOpenWidget::openDatabase()
 
     QFile file(m_filename);
     if (!file.open(QIODevice::ReadOnly)) {
-        // TODO: error message
+        MessageBox::warning(this, tr("Error"), tr("Unable to open the database.").append("\n")
+                            .append(file.errorString()));
+        return;
+    }
+
+    QByteArray transformSeed;
+    quint64 transformRounds;
+    if (!reader.readTransformParameters(&file, &transformSeed, &transformRounds)) {
+        // let readDatabase() report the error
+        readDatabase(&reader, masterKey);
+        return;
+    }
+
+    QByteArray transformedKey = transformedKeyCache()->transformedKey(masterKey, transformSeed,
+                                                                    transformRounds);
+    if (!transformedKey.isEmpty()) {
+        reader.setTransformedKey(transformSeed, transformRounds, transformedKey);
+        readDatabase(&reader, masterKey);
+        return;
+    }
+
+    new KeyTransformDialog(m_keyTransformer, this);
+    m_keyTransformer->transform(masterKey, transformSeed, transformRounds);
+}
+
+void DatabaseOpenWidget::keyTransformFinished()
+{
+    if (m_keyTransformer->isCanceled()) {
+        return;
+    }
+
+    KeePass2Reader reader;
+    reader.setTransformedKey(m_keyTransformer->seed(), m_keyTransformer->rounds(),
+                             m_keyTransformer->transformedKey());
+    readDatabase(&reader, m_keyTransformer->key());
+}
+
+void DatabaseOpenWidget::readDatabase(KeePass2Reader* reader, const CompositeKey& masterKey)
+{
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        MessageBox::warning(this, tr("Error"), tr("Unable to open the database.").append("\n")
+                            .append(file.errorString()));
         return;
     }
     if (m_db) {
         delete m_db;
     }
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    m_db = reader.readDatabase(&file, masterKey);
+    m_db = reader->readDatabase(&file, masterKey);
     QApplication::restoreOverrideCursor();
 
     if (m_db) {
@@ -132,7 +184,7 @@ void DatabaseOpenWidget::openDatabase()
     }
     else {
         MessageBox::warning(this, tr("Error"), tr("Unable to open the database.").append("\n")
-                            .append(reader.errorString()));
+                            .append(reader->errorString()));
         m_ui->editPassword->clear();
     }
 }
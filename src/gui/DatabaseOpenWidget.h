@@ -24,6 +24,8 @@
 #include "keys/CompositeKey.h"
 
 class Database;
+class KeePass2Reader;
+class KeyTransformer;
 class QFile;
 
 namespace Ui {
@@ -58,6 +60,7 @@ private Q_SLOTS:
     void setOkButtonEnabled();
     void browseKeyFile();
     void ykDetected(int slot, bool blocking);
+    void keyTransformFinished();
 
 protected:
     const QScopedPointer<Ui::DatabaseOpenWidget> m_ui;
@@ -65,6 +68,10 @@ protected:
     QString m_filename;
 
 private:
+    void readDatabase(KeePass2Reader* reader, const CompositeKey& masterKey);
+
+    KeyTransformer* const m_keyTransformer;
+
     Q_DISABLE_COPY(DatabaseOpenWidget)
 };
 
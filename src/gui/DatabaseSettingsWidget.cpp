@@ -21,12 +21,16 @@
 #include "core/Database.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "crypto/Random.h"
+#include "gui/KeyTransformDialog.h"
 #include "keys/CompositeKey.h"
+#include "keys/KeyTransformer.h"
 
 DatabaseSettingsWidget::DatabaseSettingsWidget(QWidget* parent)
     : DialogyWidget(parent)
     , m_ui(new Ui::DatabaseSettingsWidget())
     , m_db(Q_NULLPTR)
+    , m_keyTransformer(new KeyTransformer(this))
 {
     m_ui->setupUi(this);
 
@@ -37,6 +41,7 @@ DatabaseSettingsWidget::DatabaseSettingsWidget(QWidget* parent)
     connect(m_ui->historyMaxSizeCheckBox, SIGNAL(toggled(bool)),
             m_ui->historyMaxSizeSpinBox, SLOT(setEnabled(bool)));
     connect(m_ui->transformBenchmarkButton, SIGNAL(clicked()), SLOT(transformRoundsBenchmark()));
+    connect(m_keyTransformer, SIGNAL(finished()), SLOT(keyTransformFinished()));
 }
 
 DatabaseSettingsWidget::~DatabaseSettingsWidget()
@@ -76,6 +81,42 @@ void DatabaseSettingsWidget::load(Database* db)
 }
 
 void DatabaseSettingsWidget::save()
+{
+    quint64 transformRounds = static_cast<quint64>(m_ui->transformRoundsSpinBox->value());
+    if (transformRounds != m_db->transformRounds()) {
+        if (m_db->hasKey()) {
+            // the settings are applied in keyTransformFinished() so nothing
+            // is changed if the user cancels the transformation
+            if (!m_keyTransformer->isRunning()) {
+                new KeyTransformDialog(m_keyTransformer, this);
+                m_keyTransformer->transform(m_db->key(), randomGen()->randomArray(32), transformRounds);
+            }
+            return;
+        }
+
+        m_db->setTransformRounds(transformRounds);
+    }
+
+    applySettings();
+
+    Q_EMIT editFinished(true);
+}
+
+void DatabaseSettingsWidget::keyTransformFinished()
+{
+    // stay in the settings if the user canceled
+    if (m_keyTransformer->isCanceled()) {
+        return;
+    }
+
+    m_db->setKey(m_keyTransformer->key(), m_keyTransformer->seed(), m_keyTransformer->rounds(),
+                 m_keyTransformer->transformedKey());
+    applySettings();
+
+    Q_EMIT editFinished(true);
+}
+
+void DatabaseSettingsWidget::applySettings()
 {
     Metadata* meta = m_db->metadata();
 
@@ -83,12 +124,6 @@ void DatabaseSettingsWidget::save()
     meta->setDescription(m_ui->dbDescriptionEdit->text());
     meta->setDefaultUserName(m_ui->defaultUsernameEdit->text());
     meta->setRecycleBinEnabled(m_ui->recycleBinEnabledCheckBox->isChecked());
-    if (static_cast<quint64>(m_ui->transformRoundsSpinBox->value()) != m_db->transformRounds()) {
-        QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-        m_db->setTransformRounds(m_ui->transformRoundsSpinBox->value());
-        QApplication::restoreOverrideCursor();
-    }
-
     bool truncate = false;
 
     int historyMaxItems;
@@ -118,8 +153,6 @@ void DatabaseSettingsWidget::save()
     if (truncate) {
         truncateHistories();
     }
-
-    Q_EMIT editFinished(true);
 }
 
 void DatabaseSettingsWidget::reject()
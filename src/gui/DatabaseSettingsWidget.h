@@ -23,6 +23,7 @@
 #include "gui/DialogyWidget.h"
 
 class Database;
+class KeyTransformer;
 
 namespace Ui {
     class DatabaseSettingsWidget;
@@ -45,12 +46,15 @@ private Q_SLOTS:
     void save();
     void reject();
     void transformRoundsBenchmark();
+    void keyTransformFinished();
 
 private:
+    void applySettings();
     void truncateHistories();
 
     const QScopedPointer<Ui::DatabaseSettingsWidget> m_ui;
     Database* m_db;
+    KeyTransformer* const m_keyTransformer;
 
     Q_DISABLE_COPY(DatabaseSettingsWidget)
 };
@@ -33,6 +33,7 @@
 #include "gui/MessageBox.h"
 #include "gui/entry/EntryView.h"
 #include "gui/group/GroupView.h"
+#include "keys/TransformedKeyCache.h"
 
 DatabaseManagerStruct::DatabaseManagerStruct()
     : dbWidget(Q_NULLPTR)
@@ -545,6 +546,8 @@ void DatabaseTabWidget::lockDatabases()
             updateTabName(i.key());
         }
     }
+
+    transformedKeyCache()->purge();
 }
 
 void DatabaseTabWidget::modified()
@@ -617,13 +620,11 @@ void DatabaseTabWidget::performGlobalAutoType()
 {
     QList<Database*> unlockedDatabases;
 
-    QHashIterator<Database*, DatabaseManagerStruct> i(m_dbList);
-    while (i.hasNext()) {
-        i.next();
-        DatabaseWidget::Mode mode = i.value().dbWidget->currentMode();
-
-        if (mode != DatabaseWidget::LockedMode) {
-            unlockedDatabases.append(i.key());
+    // collect the databases in tab order so the matches are listed in a stable order
+    for (int i = 0; i < count(); i++) {
+        Database* db = indexDatabase(i);
+        if (db && m_dbList.value(db).dbWidget->currentMode() != DatabaseWidget::LockedMode) {
+            unlockedDatabases.append(db);
         }
     }
 
@@ -27,23 +27,26 @@
 #include <QTimer>
 
 #include "autotype/AutoType.h"
+#include "core/AsyncEntrySearcher.h"
 #include "core/Config.h"
-#include "core/EntrySearcher.h"
 #include "core/FilePath.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
+#include "crypto/Random.h"
 #include "gui/ChangeMasterKeyWidget.h"
 #include "gui/Clipboard.h"
 #include "gui/DatabaseOpenWidget.h"
 #include "gui/DatabaseSettingsWidget.h"
 #include "gui/KeePass1OpenWidget.h"
+#include "gui/KeyTransformDialog.h"
 #include "gui/MessageBox.h"
 #include "gui/UnlockDatabaseWidget.h"
 #include "gui/entry/EditEntryWidget.h"
 #include "gui/entry/EntryView.h"
 #include "gui/group/EditGroupWidget.h"
 #include "gui/group/GroupView.h"
+#include "keys/KeyTransformer.h"
 
 DatabaseWidget::DatabaseWidget(Database* db, QWidget* parent)
     : QStackedWidget(parent)
@@ -53,12 +56,16 @@ DatabaseWidget::DatabaseWidget(Database* db, QWidget* parent)
     , m_newGroup(Q_NULLPTR)
     , m_newEntry(Q_NULLPTR)
     , m_newParent(Q_NULLPTR)
+    , m_entrySearcher(new AsyncEntrySearcher(this))
+    , m_searchResultPending(false)
 {
     m_searchUi->setupUi(m_searchWidget);
 
     m_searchTimer = new QTimer(this);
     m_searchTimer->setSingleShot(true);
 
+    m_keyTransformer = new KeyTransformer(this);
+
     m_mainWidget = new QWidget(this);
     QLayout* layout = new QHBoxLayout(m_mainWidget);
     m_splitter = new QSplitter(m_mainWidget);
@@ -150,6 +157,7 @@ DatabaseWidget::DatabaseWidget(Database* db, QWidget* parent)
     connect(m_historyEditEntryWidget, SIGNAL(editFinished(bool)), SLOT(switchBackToEntryEdit()));
     connect(m_editGroupWidget, SIGNAL(editFinished(bool)), SLOT(switchToView(bool)));
     connect(m_changeMasterKeyWidget, SIGNAL(editFinished(bool)), SLOT(updateMasterKey(bool)));
+    connect(m_keyTransformer, SIGNAL(finished()), SLOT(masterKeyTransformed()));
     connect(m_databaseSettingsWidget, SIGNAL(editFinished(bool)), SLOT(switchToView(bool)));
     connect(m_databaseOpenWidget, SIGNAL(editFinished(bool)), SLOT(openDatabase(bool)));
     connect(m_keepass1OpenWidget, SIGNAL(editFinished(bool)), SLOT(openDatabase(bool)));
@@ -161,6 +169,9 @@ DatabaseWidget::DatabaseWidget(Database* db, QWidget* parent)
     connect(m_searchUi->searchRootRadioButton, SIGNAL(toggled(bool)), this, SLOT(startSearch()));
     connect(m_searchUi->searchEdit, SIGNAL(returnPressed()), m_entryView, SLOT(setFocus()));
     connect(m_searchTimer, SIGNAL(timeout()), this, SLOT(search()));
+    connect(m_db, SIGNAL(modifiedImmediate()), this, SLOT(resetSearch()));
+    connect(m_entrySearcher, SIGNAL(entriesFound(QList<Entry*>)), SLOT(searchEntriesFound(QList<Entry*>)));
+    connect(m_entrySearcher, SIGNAL(searchFinished()), SLOT(searchFinished()));
     connect(closeAction, SIGNAL(triggered()), this, SLOT(closeSearch()));
 
     setCurrentWidget(m_mainWidget);
@@ -323,9 +334,12 @@ void DatabaseWidget::deleteEntries()
         }
 
         if (result == QMessageBox::Yes) {
+            m_entryView->removeEntries(selectedEntries);
+            m_db->beginBatchUpdate();
             Q_FOREACH (Entry* entry, selectedEntries) {
                 delete entry;
             }
+            m_db->endBatchUpdate();
         }
     }
     else {
@@ -339,9 +353,12 @@ void DatabaseWidget::deleteEntries()
             }
         }
 
+        m_entryView->removeEntries(selectedEntries);
+        m_db->beginBatchUpdate();
         Q_FOREACH (Entry* entry, selectedEntries) {
             m_db->recycleEntry(entry);
         }
+        m_db->endBatchUpdate();
     }
 }
 
@@ -589,9 +606,12 @@ void DatabaseWidget::switchToGroupEdit(Group* group, bool create)
 void DatabaseWidget::updateMasterKey(bool accepted)
 {
     if (accepted) {
-        QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-        m_db->setKey(m_changeMasterKeyWidget->newMasterKey());
-        QApplication::restoreOverrideCursor();
+        if (!m_keyTransformer->isRunning()) {
+            new KeyTransformDialog(m_keyTransformer, this);
+            m_keyTransformer->transform(m_changeMasterKeyWidget->newMasterKey(), randomGen()->randomArray(32),
+                                        m_db->transformRounds());
+        }
+        return;
     }
     else if (!m_db->hasKey()) {
         Q_EMIT closeRequest();
@@ -601,11 +621,25 @@ void DatabaseWidget::updateMasterKey(bool accepted)
     setCurrentWidget(m_mainWidget);
 }
 
+void DatabaseWidget::masterKeyTransformed()
+{
+    // stay in the master key dialog if the user canceled
+    if (m_keyTransformer->isCanceled()) {
+        return;
+    }
+
+    m_db->setKey(m_keyTransformer->key(), m_keyTransformer->seed(), m_keyTransformer->rounds(),
+                 m_keyTransformer->transformedKey());
+    setCurrentWidget(m_mainWidget);
+}
+
 void DatabaseWidget::openDatabase(bool accepted)
 {
     if (accepted) {
         Database* oldDb = m_db;
         m_db = static_cast<DatabaseOpenWidget*>(sender())->database();
+        resetSearch();
+        connect(m_db, SIGNAL(modifiedImmediate()), this, SLOT(resetSearch()));
         m_groupView->changeDatabase(m_db);
         Q_EMIT databaseChanged(m_db);
         delete oldDb;
@@ -726,6 +760,7 @@ void DatabaseWidget::closeSearch()
 
     m_groupView->setCurrentGroup(m_lastGroup);
     m_searchTimer->stop();
+    m_entrySearcher->cancel();
 
     Q_EMIT listModeActivated();
 }
@@ -795,9 +830,32 @@ void DatabaseWidget::search()
         sensitivity = Qt::CaseInsensitive;
     }
 
-    QList<Entry*> searchResult = EntrySearcher().search(m_searchUi->searchEdit->text(), searchGroup, sensitivity);
+    if (!m_entryView->inEntryListMode()) {
+        m_entryView->setEntryList(QList<Entry*>());
+    }
+
+    // keep showing the previous result until the first matches arrive
+    m_searchResultPending = true;
+    m_entrySearcher->search(m_searchUi->searchEdit->text(), searchGroup, sensitivity);
+}
+
+void DatabaseWidget::searchEntriesFound(const QList<Entry*>& entries)
+{
+    if (m_searchResultPending) {
+        m_searchResultPending = false;
+        m_entryView->setEntryList(entries);
+    }
+    else {
+        m_entryView->appendEntryList(entries);
+    }
+}
 
-    m_entryView->setEntryList(searchResult);
+void DatabaseWidget::searchFinished()
+{
+    if (m_searchResultPending) {
+        m_searchResultPending = false;
+        m_entryView->setEntryList(QList<Entry*>());
+    }
 }
 
 void DatabaseWidget::startSearchTimer()
@@ -808,6 +866,18 @@ void DatabaseWidget::startSearchTimer()
     m_searchTimer->start(100);
 }
 
+void DatabaseWidget::resetSearch()
+{
+    bool searchRunning = m_entrySearcher->isRunning();
+
+    m_entrySearcher->reset();
+
+    // the running search may have been working on outdated entries
+    if (searchRunning) {
+        m_searchTimer->start(100);
+    }
+}
+
 void DatabaseWidget::startSearch()
 {
     if (!m_searchTimer->isActive()) {
@@ -848,6 +918,8 @@ void DatabaseWidget::clearLastGroup(Group* group)
     if (group) {
         m_lastGroup = Q_NULLPTR;
         m_searchWidget->hide();
+        m_searchTimer->stop();
+        m_entrySearcher->cancel();
     }
 }
 
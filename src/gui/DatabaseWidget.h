@@ -25,6 +25,7 @@
 
 #include "gui/entry/EntryModel.h"
 
+class AsyncEntrySearcher;
 class ChangeMasterKeyWidget;
 class DatabaseOpenWidget;
 class DatabaseSettingsWidget;
@@ -36,6 +37,7 @@ class EntryView;
 class Group;
 class GroupView;
 class KeePass1OpenWidget;
+class KeyTransformer;
 class QFile;
 class QMenu;
 class QSplitter;
@@ -130,6 +132,7 @@ private Q_SLOTS:
     void emitGroupContextMenuRequested(const QPoint& pos);
     void emitEntryContextMenuRequested(const QPoint& pos);
     void updateMasterKey(bool accepted);
+    void masterKeyTransformed();
     void openDatabase(bool accepted);
     void unlockDatabase(bool accepted);
     void emitCurrentModeChanged();
@@ -137,6 +140,9 @@ private Q_SLOTS:
     void search();
     void startSearch();
     void startSearchTimer();
+    void resetSearch();
+    void searchEntriesFound(const QList<Entry*>& entries);
+    void searchFinished();
     void showSearch();
     void closeSearch();
 
@@ -164,6 +170,9 @@ private:
     Group* m_newParent;
     Group* m_lastGroup;
     QTimer* m_searchTimer;
+    AsyncEntrySearcher* const m_entrySearcher;
+    bool m_searchResultPending;
+    KeyTransformer* m_keyTransformer;
     QWidget* m_widgetBeforeLock;
     QString m_filename;
 };
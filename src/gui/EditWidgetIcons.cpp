@@ -153,18 +153,11 @@ void EditWidgetIcons::removeCustomIcon()
             Uuid iconUuid = m_customIconModel->uuidFromIndex(index);
             int iconUsedCount = 0;
 
-            QList<Entry*> allEntries = m_database->rootGroup()->entriesRecursive(true);
-            QList<Entry*> historyEntriesWithSameIcon;
+            QList<Entry*> allEntries = m_database->rootGroup()->entriesRecursive();
 
             Q_FOREACH (Entry* entry, allEntries) {
-                bool isHistoryEntry = !entry->group();
-                if (iconUuid == entry->iconUuid()) {
-                    if (isHistoryEntry) {
-                        historyEntriesWithSameIcon << entry;
-                    }
-                    else if (m_currentUuid != entry->uuid()) {
-                        iconUsedCount++;
-                    }
+                if (iconUuid == entry->iconUuid() && m_currentUuid != entry->uuid()) {
+                    iconUsedCount++;
                 }
             }
 
@@ -176,10 +169,8 @@ void EditWidgetIcons::removeCustomIcon()
             }
 
             if (iconUsedCount == 0) {
-                Q_FOREACH (Entry* entry, historyEntriesWithSameIcon) {
-                    entry->setUpdateTimeinfo(false);
-                    entry->setIcon(0);
-                    entry->setUpdateTimeinfo(true);
+                Q_FOREACH (Entry* entry, allEntries) {
+                    entry->resetHistoryIcon(iconUuid);
                 }
 
                 m_database->metadata()->removeCustomIcon(iconUuid);
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KeyTransformDialog.h"
+
+#include "keys/KeyTransformer.h"
+
+KeyTransformDialog::KeyTransformDialog(KeyTransformer* transformer, QWidget* parent)
+    : QProgressDialog(parent)
+    , m_transformer(transformer)
+{
+    setWindowTitle(tr("Transforming key"));
+    setLabelText(tr("Transforming the master key..."));
+    setWindowModality(Qt::WindowModal);
+    setRange(0, 1000);
+    setMinimumDuration(500);
+    setValue(0);
+
+    connect(m_transformer, SIGNAL(progress(quint64)), SLOT(updateProgress(quint64)));
+    connect(m_transformer, SIGNAL(finished()), SLOT(deleteLater()));
+    connect(this, SIGNAL(canceled()), m_transformer, SLOT(cancel()));
+}
+
+void KeyTransformDialog::updateProgress(quint64 rounds)
+{
+    // the number of rounds doesn't necessarily fit into an int
+    setValue(static_cast<int>(rounds * 1000 / m_transformer->rounds()));
+}
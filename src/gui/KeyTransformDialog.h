@@ -0,0 +1,47 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_KEYTRANSFORMDIALOG_H
+#define KEEPASSX_KEYTRANSFORMDIALOG_H
+
+#include <QProgressDialog>
+
+#include "core/Global.h"
+
+class KeyTransformer;
+
+/**
+ * Shows the progress of a KeyTransformer and lets the user cancel it.
+ * The dialog deletes itself when the transformer has finished.
+ */
+class KeyTransformDialog : public QProgressDialog
+{
+    Q_OBJECT
+
+public:
+    explicit KeyTransformDialog(KeyTransformer* transformer, QWidget* parent = Q_NULLPTR);
+
+private Q_SLOTS:
+    void updateProgress(quint64 rounds);
+
+private:
+    KeyTransformer* const m_transformer;
+
+    Q_DISABLE_COPY(KeyTransformDialog)
+};
+
+#endif // KEEPASSX_KEYTRANSFORMDIALOG_H
@@ -28,6 +28,7 @@
 #include "core/Metadata.h"
 #include "gui/AboutDialog.h"
 #include "gui/DatabaseWidget.h"
+#include "keys/TransformedKeyCache.h"
 
 const QString MainWindow::BaseWindowTitle = "KeePassX";
 
@@ -555,6 +556,13 @@ void MainWindow::applySettingsChanges()
         m_inactivityTimer->deactivate();
     }
 
+    if (config()->get("security/cachetransformedkeys").toBool()) {
+        transformedKeyCache()->setLifetime(config()->get("security/cachetransformedkeyssec").toInt());
+    }
+    else {
+        transformedKeyCache()->setLifetime(0);
+    }
+
     updateTrayIcon();
 }
 
@@ -54,6 +54,8 @@ SettingsWidget::SettingsWidget(QWidget* parent)
             m_secUi->clearClipboardSpinBox, SLOT(setEnabled(bool)));
     connect(m_secUi->lockDatabaseIdleCheckBox, SIGNAL(toggled(bool)),
             m_secUi->lockDatabaseIdleSpinBox, SLOT(setEnabled(bool)));
+    connect(m_secUi->cacheTransformedKeysCheckBox, SIGNAL(toggled(bool)),
+            m_secUi->cacheTransformedKeysSpinBox, SLOT(setEnabled(bool)));
 }
 
 SettingsWidget::~SettingsWidget()
@@ -98,6 +100,9 @@ void SettingsWidget::loadSettings()
     m_secUi->lockDatabaseIdleCheckBox->setChecked(config()->get("security/lockdatabaseidle").toBool());
     m_secUi->lockDatabaseIdleSpinBox->setValue(config()->get("security/lockdatabaseidlesec").toInt());
 
+    m_secUi->cacheTransformedKeysCheckBox->setChecked(config()->get("security/cachetransformedkeys").toBool());
+    m_secUi->cacheTransformedKeysSpinBox->setValue(config()->get("security/cachetransformedkeyssec").toInt());
+
     m_secUi->passwordCleartextCheckBox->setChecked(config()->get("security/passwordscleartext").toBool());
 
     m_secUi->autoTypeAskCheckBox->setChecked(config()->get("security/autotypeask").toBool());
@@ -135,6 +140,9 @@ void SettingsWidget::saveSettings()
     config()->set("security/lockdatabaseidle", m_secUi->lockDatabaseIdleCheckBox->isChecked());
     config()->set("security/lockdatabaseidlesec", m_secUi->lockDatabaseIdleSpinBox->value());
 
+    config()->set("security/cachetransformedkeys", m_secUi->cacheTransformedKeysCheckBox->isChecked());
+    config()->set("security/cachetransformedkeyssec", m_secUi->cacheTransformedKeysSpinBox->value());
+
     config()->set("security/passwordscleartext", m_secUi->passwordCleartextCheckBox->isChecked());
 
     config()->set("security/autotypeask", m_secUi->autoTypeAskCheckBox->isChecked());
@@ -17,31 +17,60 @@
 
 #include "EntryModel.h"
 
-#include <QFont>
 #include <QMimeData>
+#include <QTimer>
+#include <QVector>
+#include <QtAlgorithms>
 
+#include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Tools.h"
+
+const int EntryModel::FetchBatchSize = 1000;
 
 EntryModel::EntryModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_group(Q_NULLPTR)
+    , m_fetchedRows(0)
+    , m_fetchColumn(-1)
+    , m_fetchOrder(Qt::AscendingOrder)
+    , m_insertingRow(false)
+    , m_removingRow(false)
+    , m_orgEntriesIndexed(false)
+    , m_currentTimeTimer(new QTimer(this))
+    , m_batchUpdates(0)
+    , m_batchResetting(false)
+    , m_batchDataChanged(false)
+    , m_indexedRows(0)
 {
     setSupportedDragActions(Qt::MoveAction | Qt::CopyAction);
+
+    m_expiredFont.setStrikeOut(true);
+
+    m_currentTimeTimer->setSingleShot(true);
+    m_currentTimeTimer->setInterval(0);
+    connect(m_currentTimeTimer, SIGNAL(timeout()), SLOT(invalidateCurrentTime()));
 }
 
 Entry* EntryModel::entryFromIndex(const QModelIndex& index) const
 {
-    Q_ASSERT(index.isValid() && index.row() < m_entries.size());
+    Q_ASSERT(index.isValid() && index.row() < m_fetchedRows);
     return m_entries.at(index.row());
 }
 
 QModelIndex EntryModel::indexFromEntry(Entry* entry) const
 {
-    int row = m_entries.indexOf(entry);
+    int row = rowOf(entry);
     Q_ASSERT(row != -1);
+
+    // rows that haven't been fetched yet don't have an index
+    if (row >= m_fetchedRows) {
+        return QModelIndex();
+    }
+
     return index(row, 1);
 }
 
@@ -51,52 +80,148 @@ void EntryModel::setGroup(Group* group)
         return;
     }
 
-    beginResetModel();
+    // a batch update might have started the model reset already
+    beginBatchReset();
 
     severConnections();
 
     m_group = group;
-    m_allGroups.clear();
     m_entries = group->entries();
+    m_fetchedRows = m_entries.size();
+    m_orgEntryList.clear();
     m_orgEntries.clear();
+    m_orgEntriesIndexed = false;
+    m_displayData.clear();
+    resetRows();
 
     makeConnections(group);
+    if (group->database()) {
+        connectDatabase(group->database());
+    }
 
+    m_batchUpdates = 0;
+    m_batchResetting = false;
+    m_batchDataChanged = false;
     endResetModel();
     Q_EMIT switchedToGroupMode();
 }
 
 void EntryModel::setEntryList(const QList<Entry*>& entries)
 {
-    beginResetModel();
+    // a batch update might have started the model reset already
+    beginBatchReset();
 
     severConnections();
 
     m_group = Q_NULLPTR;
-    m_allGroups.clear();
     m_entries = entries;
-    m_orgEntries = entries;
+    sortEntries(m_entries);
+    m_fetchedRows = qMin(entries.size(), FetchBatchSize);
+    m_orgEntryList = entries;
+    m_orgEntries.clear();
+    m_orgEntriesIndexed = false;
+    m_displayData.clear();
+    resetRows();
 
-    QSet<Database*> databases;
+    makeDatabaseConnections(entries);
 
-    Q_FOREACH (Entry* entry, m_entries) {
-        databases.insert(entry->group()->database());
+    m_batchUpdates = 0;
+    m_batchResetting = false;
+    m_batchDataChanged = false;
+    endResetModel();
+    Q_EMIT switchedToEntryListMode();
+}
+
+void EntryModel::appendEntryList(const QList<Entry*>& entries)
+{
+    Q_ASSERT(!m_group);
+
+    if (entries.isEmpty()) {
+        return;
     }
 
-    Q_FOREACH (Database* db, databases) {
-        Q_ASSERT(db);
-        m_allGroups.append(db->rootGroup()->groupsRecursive(true));
-        if (db->metadata()->recycleBin()) {
-            m_allGroups.removeOne(db->metadata()->recycleBin());
+    m_orgEntryList.append(entries);
+    if (m_orgEntriesIndexed) {
+        m_orgEntries.unite(entries.toSet());
+    }
+    makeDatabaseConnections(entries);
+
+    if (m_fetchColumn >= 0) {
+        insertSortedEntries(entries);
+        return;
+    }
+
+    // the new rows are added right away as long as the first batch isn't full,
+    // otherwise they are fetched by the view
+    int fetchedRows = m_fetchedRows;
+    if (m_fetchedRows == m_entries.size()) {
+        fetchedRows = qMin(m_entries.size() + entries.size(), qMax(m_fetchedRows, FetchBatchSize));
+    }
+
+    if (m_batchUpdates > 0 || fetchedRows == m_fetchedRows) {
+        if (m_batchUpdates > 0 && fetchedRows != m_fetchedRows) {
+            beginBatchReset();
         }
+        m_entries.append(entries);
+        m_fetchedRows = fetchedRows;
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_fetchedRows, fetchedRows - 1);
+    m_entries.append(entries);
+    m_fetchedRows = fetchedRows;
+    endInsertRows();
+}
+
+void EntryModel::setFetchOrder(int column, Qt::SortOrder order)
+{
+    if (column == m_fetchColumn && order == m_fetchOrder) {
+        return;
     }
 
-    Q_FOREACH (const Group* group, m_allGroups) {
-        makeConnections(group);
+    m_fetchColumn = column;
+    m_fetchOrder = order;
+
+    // all rows of a group are fetched right away
+    if (m_group || column < 0 || m_entries.size() < 2) {
+        return;
     }
 
-    endResetModel();
-    Q_EMIT switchedToEntryListMode();
+    if (m_batchUpdates > 0) {
+        beginBatchReset();
+        m_fetchedRows -= m_entries.mid(0, m_fetchedRows).count(Q_NULLPTR);
+        m_entries.removeAll(Q_NULLPTR);
+        sortEntries(m_entries);
+        resetRows();
+        return;
+    }
+
+    Q_EMIT layoutAboutToBeChanged();
+
+    const QModelIndexList oldIndexes = persistentIndexList();
+    QList<Entry*> indexEntries;
+    Q_FOREACH (const QModelIndex& index, oldIndexes) {
+        indexEntries.append(entryFromIndex(index));
+    }
+
+    sortEntries(m_entries);
+    resetRows();
+
+    // the number of fetched rows stays the same, entries that are sorted
+    // behind them lose their indexes until they are fetched again
+    QModelIndexList newIndexes;
+    for (int i = 0; i < oldIndexes.size(); i++) {
+        int row = rowOf(indexEntries.at(i));
+        if (row != -1 && row < m_fetchedRows) {
+            newIndexes.append(index(row, oldIndexes.at(i).column()));
+        }
+        else {
+            newIndexes.append(QModelIndex());
+        }
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+
+    Q_EMIT layoutChanged();
 }
 
 int EntryModel::rowCount(const QModelIndex& parent) const
@@ -105,7 +230,7 @@ int EntryModel::rowCount(const QModelIndex& parent) const
         return 0;
     }
     else {
-        return m_entries.size();
+        return m_fetchedRows;
     }
 }
 
@@ -132,11 +257,11 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
             }
             break;
         case Title:
-            return entry->title();
+            return displayData(entry).title;
         case Username:
-            return entry->username();
+            return displayData(entry).username;
         case Url:
-            return entry->url();
+            return displayData(entry).url;
         }
     }
     else if (role == Qt::DecorationRole) {
@@ -147,7 +272,7 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
             }
             break;
         case Title:
-            if (entry->isExpired()) {
+            if (isExpired(displayData(entry))) {
                 return databaseIcons()->iconPixmap(DatabaseIcons::ExpiredIconIndex);
             }
             else {
@@ -156,11 +281,12 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
         }
     }
     else if (role == Qt::FontRole) {
-        QFont font;
-        if (entry->isExpired()) {
-            font.setStrikeOut(true);
+        if (isExpired(displayData(entry))) {
+            return m_expiredFont;
+        }
+        else {
+            return m_font;
         }
-        return font;
     }
 
     return QVariant();
@@ -241,51 +367,132 @@ QMimeData* EntryModel::mimeData(const QModelIndexList& indexes) const
     }
 }
 
+void EntryModel::removeEntries(const QList<Entry*>& entries)
+{
+    if (m_batchUpdates > 0) {
+        Q_FOREACH (Entry* entry, entries) {
+            int row = rowOf(entry);
+            if (row != -1) {
+                removeBatchRow(row);
+            }
+        }
+        return;
+    }
+
+    QList<int> rows;
+    Q_FOREACH (Entry* entry, entries) {
+        int row = rowOf(entry);
+        if (row != -1) {
+            rows.append(row);
+        }
+    }
+
+    qSort(rows);
+
+    // remove from the bottom so the rows of the remaining blocks don't change
+    int last = rows.size() - 1;
+    while (last >= 0) {
+        int first = last;
+        while (first > 0 && rows.at(first - 1) == rows.at(first) - 1) {
+            first--;
+        }
+
+        // rows that haven't been fetched yet are removed silently
+        if (rows.at(first) >= m_fetchedRows) {
+            removeEntryRows(rows.at(first), rows.at(last));
+        }
+        else {
+            int lastFetched = qMin(rows.at(last), m_fetchedRows - 1);
+            beginRemoveRows(QModelIndex(), rows.at(first), lastFetched);
+            removeEntryRows(rows.at(first), rows.at(last));
+            endRemoveRows();
+        }
+
+        last = first - 1;
+    }
+}
+
 void EntryModel::entryAboutToAdd(Entry* entry)
 {
-    if (!m_group && !m_orgEntries.contains(entry)) {
+    // the row of a sorted entry list depends on the new group of the entry,
+    // it is inserted once the entry has been added
+    if (!acceptsAddedEntry(entry) || (!m_group && m_fetchColumn >= 0)) {
         return;
     }
 
-    beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
-    if (!m_group) {
+    // the entry is only shown right away if all rows have been fetched
+    bool fetched = (m_fetchedRows == m_entries.size());
+
+    if (m_batchUpdates > 0 || !fetched) {
+        if (fetched) {
+            beginBatchReset();
+            m_fetchedRows++;
+        }
         m_entries.append(entry);
+        return;
     }
+
+    beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
+    m_entries.append(entry);
+    m_fetchedRows++;
+    m_insertingRow = true;
 }
 
 void EntryModel::entryAdded(Entry* entry)
 {
-    if (!m_group && !m_orgEntries.contains(entry)) {
-        return;
+    if (m_insertingRow) {
+        m_insertingRow = false;
+        endInsertRows();
     }
-
-    if (m_group) {
-        m_entries = m_group->entries();
+    else if (!m_group && m_fetchColumn >= 0 && acceptsAddedEntry(entry)) {
+        insertSortedEntries(QList<Entry*>() << entry);
     }
-    endInsertRows();
 }
 
 void EntryModel::entryAboutToRemove(Entry* entry)
 {
-    beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
-    if (!m_group) {
-        m_entries.removeAll(entry);
+    // the row is gone already if removeEntries() has been called
+    int row = rowOf(entry);
+    if (row == -1) {
+        return;
+    }
+
+    if (m_batchUpdates > 0) {
+        removeBatchRow(row);
+        return;
     }
+
+    if (row >= m_fetchedRows) {
+        removeEntryRows(row, row);
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    removeEntryRows(row, row);
+    m_removingRow = true;
 }
 
 void EntryModel::entryRemoved()
 {
-    if (m_group) {
-        m_entries = m_group->entries();
+    if (m_removingRow) {
+        m_removingRow = false;
+        endRemoveRows();
     }
-
-    endRemoveRows();
 }
 
 void EntryModel::entryDataChanged(Entry* entry)
 {
-    int row = m_entries.indexOf(entry);
-    Q_EMIT dataChanged(index(row, 0), index(row, columnCount()-1));
+    m_displayData.remove(entry);
+
+    if (m_batchUpdates > 0) {
+        m_batchDataChanged = true;
+        return;
+    }
+
+    int row = rowOf(entry);
+    if (row != -1 && row < m_fetchedRows) {
+        Q_EMIT dataChanged(index(row, 0), index(row, columnCount()-1));
+    }
 }
 
 void EntryModel::severConnections()
@@ -294,9 +501,371 @@ void EntryModel::severConnections()
         disconnect(m_group, Q_NULLPTR, this, Q_NULLPTR);
     }
 
-    Q_FOREACH (const Group* group, m_allGroups) {
-        disconnect(group, Q_NULLPTR, this, Q_NULLPTR);
+    Q_FOREACH (Database* db, m_databases) {
+        disconnect(db, Q_NULLPTR, this, Q_NULLPTR);
+    }
+    m_databases.clear();
+}
+
+void EntryModel::makeDatabaseConnections(const QList<Entry*>& entries)
+{
+    QSet<Database*> databases;
+
+    Q_FOREACH (Entry* entry, entries) {
+        databases.insert(entry->group()->database());
+    }
+
+    Q_FOREACH (Database* db, databases) {
+        Q_ASSERT(db);
+        connectDatabase(db);
+    }
+}
+
+bool EntryModel::acceptsAddedEntry(Entry* entry) const
+{
+    if (m_group) {
+        return true;
+    }
+
+    // entries of the search result that are moved to another group stay in
+    // the list, unless they are moved to the recycle bin
+    if (!m_orgEntriesIndexed) {
+        m_orgEntries = m_orgEntryList.toSet();
+        m_orgEntriesIndexed = true;
+    }
+    if (!m_orgEntries.contains(entry)) {
+        return false;
+    }
+
+    const Group* group = entry->group();
+    return !group || !group->database() || group != group->database()->metadata()->recycleBin();
+}
+
+int EntryModel::rowOf(Entry* entry) const
+{
+    QHash<Entry*, int>::const_iterator i = m_rows.constFind(entry);
+    if (i != m_rows.constEnd() && i.value() < m_indexedRows) {
+        return i.value();
+    }
+
+    // index the rows that have been appended or moved since the last lookup
+    while (m_indexedRows < m_entries.size()) {
+        Entry* rowEntry = m_entries.at(m_indexedRows);
+        m_rows.insert(rowEntry, m_indexedRows);
+        m_indexedRows++;
+
+        if (rowEntry == entry) {
+            return m_indexedRows - 1;
+        }
+    }
+
+    return -1;
+}
+
+void EntryModel::removeEntryRows(int first, int last)
+{
+    for (int row = first; row <= last; row++) {
+        m_rows.remove(m_entries.at(row));
+        m_displayData.remove(m_entries.at(row));
+    }
+
+    m_entries.erase(m_entries.begin() + first, m_entries.begin() + last + 1);
+    m_indexedRows = qMin(m_indexedRows, first);
+
+    if (first < m_fetchedRows) {
+        m_fetchedRows -= qMin(last, m_fetchedRows - 1) - first + 1;
+    }
+}
+
+void EntryModel::removeBatchRow(int row)
+{
+    // rows that haven't been fetched yet aren't part of the model, so they
+    // can be removed right away instead of waiting for the model reset
+    if (row >= m_fetchedRows) {
+        removeEntryRows(row, row);
+    }
+    else {
+        beginBatchReset();
+        clearEntryRow(row);
+    }
+}
+
+void EntryModel::clearEntryRow(int row)
+{
+    // the empty rows are dropped when the batch update is finished
+    m_rows.remove(m_entries.at(row));
+    m_displayData.remove(m_entries.at(row));
+    m_entries[row] = Q_NULLPTR;
+}
+
+void EntryModel::beginBatchReset()
+{
+    if (!m_batchResetting) {
+        beginResetModel();
+        m_batchResetting = true;
+    }
+}
+
+void EntryModel::connectDatabase(Database* db)
+{
+    if (m_databases.contains(db)) {
+        return;
+    }
+
+    connect(db, SIGNAL(batchUpdateStarted()), SLOT(batchUpdateStarted()));
+    connect(db, SIGNAL(batchUpdateFinished()), SLOT(batchUpdateFinished()));
+
+    // in search mode a single subscription per database replaces the
+    // connections to all of its groups
+    if (!m_group) {
+        connect(db, SIGNAL(entryAboutToAdd(Entry*)), SLOT(entryAboutToAdd(Entry*)));
+        connect(db, SIGNAL(entryAdded(Entry*)), SLOT(entryAdded(Entry*)));
+        connect(db, SIGNAL(entryAboutToRemove(Entry*)), SLOT(entryAboutToRemove(Entry*)));
+        connect(db, SIGNAL(entryRemoved(Entry*)), SLOT(entryRemoved()));
+        connect(db, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
+    }
+    connect(db, SIGNAL(destroyed(QObject*)), SLOT(databaseDestroyed(QObject*)));
+
+    m_databases.append(db);
+}
+
+void EntryModel::databaseDestroyed(QObject* db)
+{
+    m_databases.removeOne(static_cast<Database*>(db));
+}
+
+void EntryModel::batchUpdateStarted()
+{
+    m_batchUpdates++;
+}
+
+void EntryModel::batchUpdateFinished()
+{
+    // the model has been reset in between
+    if (m_batchUpdates == 0) {
+        return;
+    }
+
+    m_batchUpdates--;
+    if (m_batchUpdates > 0) {
+        return;
+    }
+
+    if (m_batchResetting) {
+        m_fetchedRows -= m_entries.mid(0, m_fetchedRows).count(Q_NULLPTR);
+        m_entries.removeAll(Q_NULLPTR);
+        m_displayData.clear();
+        resetRows();
+        m_batchResetting = false;
+        m_batchDataChanged = false;
+        endResetModel();
+    }
+    else if (m_batchDataChanged && m_fetchedRows > 0) {
+        m_batchDataChanged = false;
+        Q_EMIT dataChanged(index(0, 0), index(m_fetchedRows - 1, columnCount() - 1));
+    }
+    else {
+        m_batchDataChanged = false;
+    }
+}
+
+bool EntryModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_fetchedRows < m_entries.size();
+}
+
+void EntryModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    int fetchedRows = qMin(m_entries.size(), m_fetchedRows + FetchBatchSize);
+
+    beginInsertRows(QModelIndex(), m_fetchedRows, fetchedRows - 1);
+    m_fetchedRows = fetchedRows;
+    endInsertRows();
+}
+
+const EntryModel::DisplayData& EntryModel::displayData(Entry* entry) const
+{
+    QHash<const Entry*, DisplayData>::iterator i = m_displayData.find(entry);
+    if (i == m_displayData.end()) {
+        const TimeInfo timeInfo = entry->timeInfo();
+
+        DisplayData data;
+        data.title = entry->title();
+        data.username = entry->username();
+        data.url = entry->url();
+        data.expires = timeInfo.expires();
+        data.expiryTime = timeInfo.expiryTime();
+        i = m_displayData.insert(entry, data);
+    }
+
+    return i.value();
+}
+
+bool EntryModel::isExpired(const DisplayData& data) const
+{
+    if (!data.expires) {
+        return false;
+    }
+
+    if (m_currentTime.isNull()) {
+        m_currentTime = Tools::currentDateTimeUtc();
+        m_currentTimeTimer->start();
+    }
+
+    return data.expiryTime < m_currentTime;
+}
+
+void EntryModel::invalidateCurrentTime()
+{
+    m_currentTime = QDateTime();
+}
+
+void EntryModel::resetRows()
+{
+    m_rows.clear();
+    m_indexedRows = 0;
+}
+
+EntryModel::SortKeyLessThan::SortKeyLessThan(Qt::SortOrder order)
+    : m_order(order)
+{
+}
+
+bool EntryModel::SortKeyLessThan::operator()(const SortKey& left, const SortKey& right) const
+{
+    // compares like the locale aware sorting of QSortFilterProxyModel
+    int cmp = left.key.localeAwareCompare(right.key);
+    if (cmp != 0) {
+        return (m_order == Qt::AscendingOrder) ? (cmp < 0) : (cmp > 0);
+    }
+
+    return left.title.localeAwareCompare(right.title) < 0;
+}
+
+EntryModel::SortKey EntryModel::sortKey(Entry* entry) const
+{
+    SortKey key;
+    key.entry = entry;
+    key.title = entry->title();
+
+    switch (m_fetchColumn) {
+    case ParentGroup:
+        if (entry->group()) {
+            key.key = entry->group()->name();
+        }
+        break;
+    case Title:
+        key.key = key.title;
+        break;
+    case Username:
+        key.key = entry->username();
+        break;
+    case Url:
+        key.key = entry->url();
+        break;
+    }
+
+    return key;
+}
+
+void EntryModel::sortEntries(QList<Entry*>& entries) const
+{
+    if (m_fetchColumn < 0 || entries.size() < 2) {
+        return;
+    }
+
+    QVector<SortKey> keys;
+    keys.reserve(entries.size());
+    Q_FOREACH (Entry* entry, entries) {
+        keys.append(sortKey(entry));
+    }
+
+    qStableSort(keys.begin(), keys.end(), SortKeyLessThan(m_fetchOrder));
+
+    for (int i = 0; i < keys.size(); i++) {
+        entries[i] = keys.at(i).entry;
+    }
+}
+
+void EntryModel::insertSortedEntries(const QList<Entry*>& entries)
+{
+    QList<Entry*> added = entries;
+    sortEntries(added);
+
+    SortKeyLessThan lessThan(m_fetchOrder);
+    QList<Entry*> unfetched;
+    int row = 0;
+
+    Q_FOREACH (Entry* entry, added) {
+        SortKey key = sortKey(entry);
+
+        // skip the fetched rows that are sorted before the entry, rows that
+        // have been cleared during a batch update are skipped as well
+        while (row < m_fetchedRows && (!m_entries.at(row) || !lessThan(key, sortKey(m_entries.at(row))))) {
+            row++;
+        }
+
+        // entries that are sorted in between the fetched rows are shown right
+        // away, like the rows of the first batch
+        bool allFetched = (m_fetchedRows == m_entries.size());
+        if (row < m_fetchedRows || (allFetched && m_fetchedRows < FetchBatchSize)) {
+            if (m_batchUpdates > 0) {
+                beginBatchReset();
+            }
+            else {
+                beginInsertRows(QModelIndex(), row, row);
+            }
+
+            m_entries.insert(row, entry);
+            m_fetchedRows++;
+            m_indexedRows = qMin(m_indexedRows, row);
+
+            if (m_batchUpdates == 0) {
+                endInsertRows();
+            }
+            row++;
+        }
+        else {
+            unfetched.append(entry);
+        }
+    }
+
+    if (unfetched.isEmpty()) {
+        return;
+    }
+
+    // merge the remaining entries into the rows that haven't been fetched yet
+    QList<Entry*> merged = m_entries.mid(0, m_fetchedRows);
+    int first = m_fetchedRows;
+
+    Q_FOREACH (Entry* entry, unfetched) {
+        SortKey key = sortKey(entry);
+
+        // the first row that is sorted after the entry
+        int begin = first;
+        int end = m_entries.size();
+        while (begin < end) {
+            int middle = begin + (end - begin) / 2;
+            if (lessThan(key, sortKey(m_entries.at(middle)))) {
+                end = middle;
+            }
+            else {
+                begin = middle + 1;
+            }
+        }
+
+        merged.append(m_entries.mid(first, begin - first));
+        merged.append(entry);
+        first = begin;
     }
+    merged.append(m_entries.mid(first));
+
+    m_entries = merged;
+    m_indexedRows = qMin(m_indexedRows, m_fetchedRows);
 }
 
 void EntryModel::makeConnections(const Group* group)
@@ -19,11 +19,17 @@
 #define KEEPASSX_ENTRYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QDateTime>
+#include <QFont>
+#include <QHash>
+#include <QSet>
 
 #include "core/Global.h"
 
+class Database;
 class Entry;
 class Group;
+class QTimer;
 
 class EntryModel : public QAbstractTableModel
 {
@@ -50,8 +56,33 @@ public:
     Qt::ItemFlags flags(const QModelIndex& modelIndex) const Q_DECL_OVERRIDE;
     QStringList mimeTypes() const Q_DECL_OVERRIDE;
     QMimeData* mimeData(const QModelIndexList& indexes) const Q_DECL_OVERRIDE;
+    bool canFetchMore(const QModelIndex& parent) const Q_DECL_OVERRIDE;
+    void fetchMore(const QModelIndex& parent) Q_DECL_OVERRIDE;
 
+    /**
+     * Shows a list of entries, e.g. search results. Only the first
+     * FetchBatchSize rows are added right away, the view fetches the rest
+     * when it's scrolled down.
+     */
     void setEntryList(const QList<Entry*>& entries);
+    void appendEntryList(const QList<Entry*>& entries);
+
+    /**
+     * Keeps the entry list sorted by column like the view does, so each
+     * fetched batch continues below the rows that are shown already instead
+     * of being sorted in between them. A column of -1 keeps the order of
+     * the list.
+     */
+    void setFetchOrder(int column, Qt::SortOrder order);
+
+    /**
+     * Removes the rows of entries that are about to be deleted or moved to
+     * another group. Contiguous rows are removed together. The entries
+     * have to be removed from their groups right after this call.
+     */
+    void removeEntries(const QList<Entry*>& entries);
+
+    static const int FetchBatchSize;
 
 Q_SIGNALS:
     void switchedToEntryListMode();
@@ -66,15 +97,89 @@ private Q_SLOTS:
     void entryAboutToRemove(Entry* entry);
     void entryRemoved();
     void entryDataChanged(Entry* entry);
+    void batchUpdateStarted();
+    void batchUpdateFinished();
+    void databaseDestroyed(QObject* db);
+    void invalidateCurrentTime();
 
 private:
+    struct DisplayData
+    {
+        QString title;
+        QString username;
+        QString url;
+        bool expires;
+        QDateTime expiryTime;
+    };
+
+    struct SortKey
+    {
+        Entry* entry;
+        QString key;
+        // orders entries with equal keys
+        QString title;
+    };
+
+    class SortKeyLessThan
+    {
+    public:
+        explicit SortKeyLessThan(Qt::SortOrder order);
+        bool operator()(const SortKey& left, const SortKey& right) const;
+
+    private:
+        Qt::SortOrder m_order;
+    };
+
     void severConnections();
     void makeConnections(const Group* group);
+    void makeDatabaseConnections(const QList<Entry*>& entries);
+    void connectDatabase(Database* db);
+    bool acceptsAddedEntry(Entry* entry) const;
+    const DisplayData& displayData(Entry* entry) const;
+    bool isExpired(const DisplayData& data) const;
+    int rowOf(Entry* entry) const;
+    void removeEntryRows(int first, int last);
+    void removeBatchRow(int row);
+    void clearEntryRow(int row);
+    void beginBatchReset();
+    void resetRows();
+    SortKey sortKey(Entry* entry) const;
+    void sortEntries(QList<Entry*>& entries) const;
+    void insertSortedEntries(const QList<Entry*>& entries);
 
     Group* m_group;
     QList<Entry*> m_entries;
-    QList<Entry*> m_orgEntries;
-    QList<const Group*> m_allGroups;
+    // only the first m_fetchedRows entries have been added to the model
+    int m_fetchedRows;
+    int m_fetchColumn;
+    Qt::SortOrder m_fetchOrder;
+    QList<Database*> m_databases;
+    bool m_insertingRow;
+    bool m_removingRow;
+
+    // the entries of the search result, the set is only built when an
+    // entry is added back to the list
+    QList<Entry*> m_orgEntryList;
+    mutable QSet<Entry*> m_orgEntries;
+    mutable bool m_orgEntriesIndexed;
+
+    mutable QHash<const Entry*, DisplayData> m_displayData;
+    // the current time is read once for all rows painted in the same
+    // event loop iteration
+    mutable QDateTime m_currentTime;
+    QTimer* const m_currentTimeTimer;
+    QFont m_font;
+    QFont m_expiredFont;
+
+    // number of nested batch updates of the connected databases, structural
+    // changes during a batch update are applied with a single model reset
+    int m_batchUpdates;
+    bool m_batchResetting;
+    bool m_batchDataChanged;
+
+    // rows of the entries, only valid for rows smaller than m_indexedRows
+    mutable QHash<Entry*, int> m_rows;
+    mutable int m_indexedRows;
 };
 
 #endif // KEEPASSX_ENTRYMODEL_H
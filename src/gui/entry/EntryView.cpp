@@ -50,6 +50,9 @@ EntryView::EntryView(QWidget* parent)
     connect(selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), SIGNAL(entrySelectionChanged()));
     connect(m_model, SIGNAL(switchedToEntryListMode()), SLOT(switchToEntryListMode()));
     connect(m_model, SIGNAL(switchedToGroupMode()), SLOT(switchToGroupMode()));
+    // connected after setSortingEnabled() so the proxy is sorted already
+    connect(header(), SIGNAL(sortIndicatorChanged(int,Qt::SortOrder)), SLOT(updateFetchMode()));
+    updateFetchMode();
 }
 
 void EntryView::keyPressEvent(QKeyEvent* event)
@@ -73,6 +76,22 @@ void EntryView::setEntryList(const QList<Entry*>& entries)
     setFirstEntryActive();
 }
 
+void EntryView::appendEntryList(const QList<Entry*>& entries)
+{
+    bool wasEmpty = (m_model->rowCount() == 0);
+
+    m_model->appendEntryList(entries);
+
+    if (wasEmpty) {
+        setFirstEntryActive();
+    }
+}
+
+void EntryView::removeEntries(const QList<Entry*>& entries)
+{
+    m_model->removeEntries(entries);
+}
+
 void EntryView::setFirstEntryActive()
 {
     if(m_model->rowCount() > 0) {
@@ -140,6 +159,7 @@ void EntryView::switchToEntryListMode()
     sortByColumn(1, Qt::AscendingOrder); // TODO: should probably be improved
     sortByColumn(0, Qt::AscendingOrder);
     m_inEntryListMode = true;
+    updateFetchMode();
 }
 
 void EntryView::switchToGroupMode()
@@ -148,4 +168,18 @@ void EntryView::switchToGroupMode()
     sortByColumn(-1, Qt::AscendingOrder);
     sortByColumn(0, Qt::AscendingOrder);
     m_inEntryListMode = false;
+    updateFetchMode();
+}
+
+void EntryView::updateFetchMode()
+{
+    // the model fetches the rows of an entry list in the order they are
+    // shown, the columns of the proxy only match the model columns in entry
+    // list mode where no column is hidden
+    if (m_inEntryListMode) {
+        m_model->setFetchOrder(m_sortModel->sortColumn(), m_sortModel->sortOrder());
+    }
+    else {
+        m_model->setFetchOrder(-1, Qt::AscendingOrder);
+    }
 }
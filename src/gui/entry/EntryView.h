@@ -40,6 +40,8 @@ public:
     void setCurrentEntry(Entry* entry);
     Entry* entryFromIndex(const QModelIndex& index);
     void setEntryList(const QList<Entry*>& entries);
+    void appendEntryList(const QList<Entry*>& entries);
+    void removeEntries(const QList<Entry*>& entries);
     bool inEntryListMode();
     int numberOfSelectedEntries();
     void setFirstEntryActive();
@@ -58,6 +60,7 @@ private Q_SLOTS:
     void emitEntryActivated(const QModelIndex& index);
     void switchToEntryListMode();
     void switchToGroupMode();
+    void updateFetchMode();
 
 private:
     EntryModel* const m_model;
@@ -278,6 +278,11 @@ bool GroupModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
             return false;
         }
 
+        // notify the models of all involved databases only once
+        QList<Database*> batchDatabases;
+        batchDatabases.append(parentGroup->database());
+        parentGroup->database()->beginBatchUpdate();
+
         while (!stream.atEnd()) {
             Uuid dbUuid;
             Uuid entryUuid;
@@ -305,6 +310,11 @@ bool GroupModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
             Database* targetDb = parentGroup->database();
             Uuid customIcon = entry->iconUuid();
 
+            if (!batchDatabases.contains(sourceDb)) {
+                batchDatabases.append(sourceDb);
+                sourceDb->beginBatchUpdate();
+            }
+
             if (sourceDb != targetDb && !customIcon.isNull()
                     && !targetDb->metadata()->containsCustomIcon(customIcon)) {
                 targetDb->metadata()->addCustomIcon(customIcon,
@@ -313,6 +323,10 @@ bool GroupModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
 
             entry->setGroup(parentGroup);
         }
+
+        Q_FOREACH (Database* db, batchDatabases) {
+            db->endBatchUpdate();
+        }
     }
 
     return true;
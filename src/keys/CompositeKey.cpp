@@ -16,14 +16,12 @@
 */
 
 #include "CompositeKey.h"
-#include "CompositeKey_p.h"
 #include "ChallengeResponseKey.h"
 
-#include <QtConcurrentRun>
 #include <QTime>
 
+#include "crypto/AesKdf.h"
 #include "crypto/CryptoHash.h"
-#include "crypto/SymmetricCipher.h"
 
 CompositeKey::CompositeKey()
 {
@@ -94,28 +92,10 @@ QByteArray CompositeKey::transform(const QByteArray& seed, quint64 rounds) const
 
     QByteArray key = rawKey();
 
-    QFuture<QByteArray> future = QtConcurrent::run(transformKeyRaw, key.left(16), seed, rounds);
-    QByteArray result2 = transformKeyRaw(key.right(16), seed, rounds);
+    AesKdf kdf(seed);
+    kdf.processInPlace(key, rounds);
 
-    QByteArray transformed;
-    transformed.append(future.result());
-    transformed.append(result2);
-
-    return CryptoHash::hash(transformed, CryptoHash::Sha256);
-}
-
-QByteArray CompositeKey::transformKeyRaw(const QByteArray& key, const QByteArray& seed,
-                                         quint64 rounds)
-{
-    QByteArray iv(16, 0);
-    SymmetricCipher cipher(SymmetricCipher::Aes256, SymmetricCipher::Ecb,
-                           SymmetricCipher::Encrypt, seed, iv);
-
-    QByteArray result = key;
-
-    cipher.processInPlace(result, rounds);
-
-    return result;
+    return CryptoHash::hash(key, CryptoHash::Sha256);
 }
 
 bool CompositeKey::challenge(const QByteArray& seed, QByteArray& result) const
@@ -153,46 +133,23 @@ void CompositeKey::addChallengeResponseKey(const ChallengeResponseKey& key)
 }
 
 int CompositeKey::transformKeyBenchmark(int msec)
-{
-    TransformKeyBenchmarkThread thread1(msec);
-    TransformKeyBenchmarkThread thread2(msec);
-
-    thread1.start();
-    thread2.start();
-
-    thread1.wait();
-    thread2.wait();
-
-    return qMin(thread1.rounds(), thread2.rounds());
-}
-
-
-TransformKeyBenchmarkThread::TransformKeyBenchmarkThread(int msec)
-    : m_msec(msec)
-    , m_rounds(0)
 {
     Q_ASSERT(msec > 0);
-}
-
-int TransformKeyBenchmarkThread::rounds()
-{
-    return m_rounds;
-}
 
-void TransformKeyBenchmarkThread::run()
-{
-    QByteArray key = QByteArray(16, '\x7E');
+    QByteArray key = QByteArray(32, '\x7E');
     QByteArray seed = QByteArray(32, '\x4B');
-    QByteArray iv(16, 0);
-
-    SymmetricCipher cipher(SymmetricCipher::Aes256, SymmetricCipher::Ecb,
-                           SymmetricCipher::Encrypt, seed, iv);
+    AesKdf kdf(seed);
+    int rounds = 0;
 
     QTime t;
     t.start();
 
+    // large enough steps so the overhead of the thread pool doesn't distort
+    // the result if the halves are transformed on separate threads
     do {
-        cipher.processInPlace(key, 100);
-        m_rounds += 100;
-    } while (t.elapsed() < m_msec);
+        kdf.processInPlace(key, 10000);
+        rounds += 10000;
+    } while (t.elapsed() < msec);
+
+    return rounds;
 }
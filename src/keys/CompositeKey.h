@@ -44,9 +44,6 @@ public:
     static int transformKeyBenchmark(int msec);
 
 private:
-    static QByteArray transformKeyRaw(const QByteArray& key, const QByteArray& seed,
-                                      quint64 rounds);
-
     QList<Key*> m_keys;
     QList<ChallengeResponseKey*> m_challengeResponseKeys;
 };
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KeyTransformer.h"
+
+#include "crypto/AesKdf.h"
+#include "crypto/CryptoHash.h"
+
+// number of rounds between two checks for cancellation
+const quint64 KeyTransformer::RoundsPerStep = 10000;
+
+KeyTransformer::KeyTransformer(QObject* parent)
+    : QThread(parent)
+    , m_rounds(0)
+    , m_canceled(0)
+{
+}
+
+KeyTransformer::~KeyTransformer()
+{
+    cancel();
+    wait();
+}
+
+void KeyTransformer::transform(const CompositeKey& key, const QByteArray& seed, quint64 rounds)
+{
+    Q_ASSERT(seed.size() == 32);
+    Q_ASSERT(rounds > 0);
+    Q_ASSERT(!isRunning());
+
+    m_key = key;
+    m_seed = seed;
+    m_rounds = rounds;
+    m_transformedKey.clear();
+    m_canceled = 0;
+
+    start();
+}
+
+void KeyTransformer::cancel()
+{
+    m_canceled = 1;
+}
+
+bool KeyTransformer::isCanceled() const
+{
+    return m_canceled != 0;
+}
+
+CompositeKey KeyTransformer::key() const
+{
+    return m_key;
+}
+
+QByteArray KeyTransformer::seed() const
+{
+    return m_seed;
+}
+
+quint64 KeyTransformer::rounds() const
+{
+    return m_rounds;
+}
+
+QByteArray KeyTransformer::transformedKey() const
+{
+    return m_transformedKey;
+}
+
+void KeyTransformer::run()
+{
+    QByteArray key = m_key.rawKey();
+    AesKdf kdf(m_seed);
+
+    quint64 done = 0;
+    while (done < m_rounds && !isCanceled()) {
+        quint64 step = qMin(m_rounds - done, RoundsPerStep);
+        kdf.processInPlace(key, step);
+        done += step;
+
+        Q_EMIT progress(done);
+    }
+
+    if (isCanceled()) {
+        return;
+    }
+
+    m_transformedKey = CryptoHash::hash(key, CryptoHash::Sha256);
+}
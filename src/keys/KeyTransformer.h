@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_KEYTRANSFORMER_H
+#define KEEPASSX_KEYTRANSFORMER_H
+
+#include <QAtomicInt>
+#include <QThread>
+
+#include "keys/CompositeKey.h"
+
+/**
+ * Computes CompositeKey::transform() on a background thread.
+ *
+ * progress() reports the number of rounds completed so far. finished() is
+ * emitted once transformedKey() is available or the transformation has been
+ * canceled. transform() must not be called while a transformation is running.
+ */
+class KeyTransformer : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit KeyTransformer(QObject* parent = Q_NULLPTR);
+    ~KeyTransformer();
+    void transform(const CompositeKey& key, const QByteArray& seed, quint64 rounds);
+    bool isCanceled() const;
+    CompositeKey key() const;
+    QByteArray seed() const;
+    quint64 rounds() const;
+    QByteArray transformedKey() const;
+
+    static const quint64 RoundsPerStep;
+
+public Q_SLOTS:
+    void cancel();
+
+Q_SIGNALS:
+    void progress(quint64 rounds);
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    CompositeKey m_key;
+    QByteArray m_seed;
+    quint64 m_rounds;
+    QByteArray m_transformedKey;
+    QAtomicInt m_canceled;
+
+    Q_DISABLE_COPY(KeyTransformer)
+};
+
+#endif // KEEPASSX_KEYTRANSFORMER_H
@@ -0,0 +1,245 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TransformedKeyCache.h"
+
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#endif
+
+#include "core/Tools.h"
+#include "crypto/CryptoHash.h"
+#include "keys/CompositeKey.h"
+
+struct TransformedKeyCache::Entry
+{
+    bool used;
+    quint32 serial;
+    uint expires;
+    quint64 rounds;
+    char keyHash[32];
+    char seed[32];
+    char transformedKey[32];
+};
+
+namespace {
+
+void wipe(void* data, size_t size)
+{
+    // volatile so the compiler doesn't optimize away the writes
+    volatile char* p = static_cast<volatile char*>(data);
+    while (size--) {
+        *p++ = 0;
+    }
+}
+
+bool lockMemory(void* data, size_t size)
+{
+#if defined(Q_OS_WIN)
+    return VirtualLock(data, size) != 0;
+#elif defined(Q_OS_UNIX)
+    return mlock(data, size) == 0;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+void unlockMemory(void* data, size_t size)
+{
+#if defined(Q_OS_WIN)
+    VirtualUnlock(data, size);
+#elif defined(Q_OS_UNIX)
+    munlock(data, size);
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+#endif
+}
+
+}
+
+TransformedKeyCache* TransformedKeyCache::m_instance(Q_NULLPTR);
+
+const int TransformedKeyCache::MaxEntries = 16;
+
+TransformedKeyCache::TransformedKeyCache(QObject* parent)
+    : QObject(parent)
+    , m_entries(static_cast<Entry*>(qMalloc(sizeof(Entry) * MaxEntries)))
+    , m_memoryLocked(lockMemory(m_entries, sizeof(Entry) * MaxEntries))
+    , m_lifetime(0)
+    , m_serial(0)
+    , m_timer(new QTimer(this))
+{
+    Q_CHECK_PTR(m_entries);
+    wipe(m_entries, sizeof(Entry) * MaxEntries);
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, SIGNAL(timeout()), SLOT(purgeExpired()));
+    connect(qApp, SIGNAL(aboutToQuit()), SLOT(purge()));
+}
+
+TransformedKeyCache::~TransformedKeyCache()
+{
+    wipe(m_entries, sizeof(Entry) * MaxEntries);
+    if (m_memoryLocked) {
+        unlockMemory(m_entries, sizeof(Entry) * MaxEntries);
+    }
+    qFree(m_entries);
+}
+
+QByteArray TransformedKeyCache::transformedKey(const CompositeKey& key, const QByteArray& seed,
+                                               quint64 rounds)
+{
+    if (m_lifetime <= 0) {
+        return QByteArray();
+    }
+
+    purgeExpired();
+
+    Entry* entry = findEntry(CryptoHash::hash(key.rawKey(), CryptoHash::Sha256), seed, rounds);
+    if (!entry) {
+        return QByteArray();
+    }
+
+    return QByteArray(entry->transformedKey, sizeof(entry->transformedKey));
+}
+
+void TransformedKeyCache::insert(const CompositeKey& key, const QByteArray& seed, quint64 rounds,
+                                 const QByteArray& transformedKey)
+{
+    if (m_lifetime <= 0 || seed.size() != 32 || transformedKey.size() != 32) {
+        return;
+    }
+
+    QByteArray keyHash = CryptoHash::hash(key.rawKey(), CryptoHash::Sha256);
+    Entry* entry = findEntry(keyHash, seed, rounds);
+
+    if (!entry) {
+        // take a free entry or replace the oldest one
+        entry = &m_entries[0];
+        for (int i = 0; i < MaxEntries && entry->used; i++) {
+            if (!m_entries[i].used || m_entries[i].serial < entry->serial) {
+                entry = &m_entries[i];
+            }
+        }
+    }
+
+    entry->used = true;
+    entry->serial = m_serial++;
+    entry->expires = Tools::currentDateTimeUtc().toTime_t() + m_lifetime;
+    entry->rounds = rounds;
+    memcpy(entry->keyHash, keyHash.constData(), sizeof(entry->keyHash));
+    memcpy(entry->seed, seed.constData(), sizeof(entry->seed));
+    memcpy(entry->transformedKey, transformedKey.constData(), sizeof(entry->transformedKey));
+
+    scheduleExpiry();
+}
+
+int TransformedKeyCache::lifetime() const
+{
+    return m_lifetime;
+}
+
+void TransformedKeyCache::setLifetime(int sec)
+{
+    m_lifetime = sec;
+
+    if (m_lifetime <= 0) {
+        purge();
+    }
+}
+
+bool TransformedKeyCache::isMemoryLocked() const
+{
+    return m_memoryLocked;
+}
+
+void TransformedKeyCache::purge()
+{
+    m_timer->stop();
+    wipe(m_entries, sizeof(Entry) * MaxEntries);
+}
+
+void TransformedKeyCache::purgeExpired()
+{
+    uint now = Tools::currentDateTimeUtc().toTime_t();
+
+    for (int i = 0; i < MaxEntries; i++) {
+        if (m_entries[i].used && m_entries[i].expires <= now) {
+            wipe(&m_entries[i], sizeof(Entry));
+        }
+    }
+
+    scheduleExpiry();
+}
+
+TransformedKeyCache::Entry* TransformedKeyCache::findEntry(const QByteArray& keyHash, const QByteArray& seed,
+                                                           quint64 rounds)
+{
+    Q_ASSERT(keyHash.size() == 32);
+
+    if (seed.size() != 32) {
+        return Q_NULLPTR;
+    }
+
+    for (int i = 0; i < MaxEntries; i++) {
+        Entry* entry = &m_entries[i];
+        if (entry->used && entry->rounds == rounds
+                && memcmp(entry->keyHash, keyHash.constData(), sizeof(entry->keyHash)) == 0
+                && memcmp(entry->seed, seed.constData(), sizeof(entry->seed)) == 0) {
+            return entry;
+        }
+    }
+
+    return Q_NULLPTR;
+}
+
+void TransformedKeyCache::scheduleExpiry()
+{
+    uint next = 0;
+    for (int i = 0; i < MaxEntries; i++) {
+        if (m_entries[i].used && (next == 0 || m_entries[i].expires < next)) {
+            next = m_entries[i].expires;
+        }
+    }
+
+    if (next == 0) {
+        m_timer->stop();
+        return;
+    }
+
+    uint now = Tools::currentDateTimeUtc().toTime_t();
+    m_timer->start(next > now ? (next - now) * 1000 : 0);
+}
+
+TransformedKeyCache* TransformedKeyCache::instance()
+{
+    if (!m_instance) {
+        m_instance = new TransformedKeyCache(qApp);
+    }
+
+    return m_instance;
+}
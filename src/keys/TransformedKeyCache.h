@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_TRANSFORMEDKEYCACHE_H
+#define KEEPASSX_TRANSFORMEDKEYCACHE_H
+
+#include <QObject>
+
+#include "core/Global.h"
+
+class CompositeKey;
+class QTimer;
+
+/**
+ * Remembers transformed master keys for the current session so reopening
+ * a database with an unchanged transform seed doesn't run the key
+ * transformation again.
+ *
+ * Entries are kept in locked memory (if the platform allows it) and are
+ * wiped once their lifetime has passed, on purge() and when the application
+ * quits. The cache is disabled until a lifetime is set.
+ */
+class TransformedKeyCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~TransformedKeyCache();
+    QByteArray transformedKey(const CompositeKey& key, const QByteArray& seed, quint64 rounds);
+    void insert(const CompositeKey& key, const QByteArray& seed, quint64 rounds,
+                const QByteArray& transformedKey);
+    int lifetime() const;
+    void setLifetime(int sec);
+    bool isMemoryLocked() const;
+
+    static TransformedKeyCache* instance();
+
+    static const int MaxEntries;
+
+public Q_SLOTS:
+    void purge();
+
+private Q_SLOTS:
+    void purgeExpired();
+
+private:
+    struct Entry;
+
+    explicit TransformedKeyCache(QObject* parent = Q_NULLPTR);
+    Entry* findEntry(const QByteArray& keyHash, const QByteArray& seed, quint64 rounds);
+    void scheduleExpiry();
+
+    static TransformedKeyCache* m_instance;
+
+    Entry* const m_entries;
+    const bool m_memoryLocked;
+    int m_lifetime;
+    quint32 m_serial;
+    QTimer* const m_timer;
+
+    Q_DISABLE_COPY(TransformedKeyCache)
+};
+
+inline TransformedKeyCache* transformedKeyCache() {
+    return TransformedKeyCache::instance();
+}
+
+#endif // KEEPASSX_TRANSFORMEDKEYCACHE_H
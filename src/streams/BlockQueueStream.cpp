@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BlockQueueStream.h"
+
+#include <cstring>
+
+BlockQueueStream::BlockQueueStream(int maxBlocks, QObject* parent)
+    : QIODevice(parent)
+    , m_maxBlocks(maxBlocks)
+    , m_blockPos(0)
+    , m_bytesQueued(0)
+    , m_finished(false)
+    , m_aborted(false)
+    , m_error(false)
+{
+    Q_ASSERT(maxBlocks > 0);
+}
+
+BlockQueueStream::~BlockQueueStream()
+{
+    abort();
+}
+
+bool BlockQueueStream::isSequential() const
+{
+    return true;
+}
+
+bool BlockQueueStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::WriteOnly) {
+        qWarning("BlockQueueStream::open: Writing is not supported.");
+        return false;
+    }
+
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+bool BlockQueueStream::atEnd() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return (m_finished || m_aborted) && m_blocks.isEmpty();
+}
+
+qint64 BlockQueueStream::bytesAvailable() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_bytesQueued + QIODevice::bytesAvailable();
+}
+
+bool BlockQueueStream::enqueue(const QByteArray& block)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Q_ASSERT(!m_finished);
+
+    while (m_blocks.size() >= m_maxBlocks && !m_aborted) {
+        m_notFull.wait(&m_mutex);
+    }
+
+    if (m_aborted) {
+        return false;
+    }
+
+    if (!block.isEmpty()) {
+        m_blocks.enqueue(block);
+        m_bytesQueued += block.size();
+        m_notEmpty.wakeOne();
+    }
+
+    return true;
+}
+
+void BlockQueueStream::finish()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_finished = true;
+    m_notEmpty.wakeAll();
+}
+
+void BlockQueueStream::finishWithError(const QString& errorString)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_finished = true;
+    m_error = true;
+    m_producerErrorString = errorString;
+    m_notEmpty.wakeAll();
+}
+
+void BlockQueueStream::abort()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_aborted = true;
+    m_blocks.clear();
+    m_blockPos = 0;
+    m_bytesQueued = 0;
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
+
+qint64 BlockQueueStream::readData(char* data, qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+
+    qint64 bytesRead = 0;
+
+    while (bytesRead < maxSize) {
+        while (m_blocks.isEmpty() && !m_finished && !m_aborted) {
+            m_notEmpty.wait(&m_mutex);
+        }
+
+        if (m_blocks.isEmpty()) {
+            break;
+        }
+
+        const QByteArray& block = m_blocks.head();
+        int bytesToCopy = qMin(maxSize - bytesRead, static_cast<qint64>(block.size() - m_blockPos));
+
+        memcpy(data + bytesRead, block.constData() + m_blockPos, bytesToCopy);
+
+        bytesRead += bytesToCopy;
+        m_blockPos += bytesToCopy;
+        m_bytesQueued -= bytesToCopy;
+
+        if (m_blockPos == block.size()) {
+            m_blocks.dequeue();
+            m_blockPos = 0;
+            m_notFull.wakeOne();
+        }
+    }
+
+    if (bytesRead == 0 && (m_error || m_aborted)) {
+        if (m_error) {
+            setErrorString(m_producerErrorString);
+        }
+        return -1;
+    }
+
+    return bytesRead;
+}
+
+qint64 BlockQueueStream::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+
+    return -1;
+}
+
+
+BlockQueueFeeder::BlockQueueFeeder(QIODevice* source, BlockQueueStream* sink, int chunkSize)
+    : m_source(source)
+    , m_sink(sink)
+    , m_chunkSize(chunkSize)
+{
+    Q_ASSERT(chunkSize > 0);
+}
+
+void BlockQueueFeeder::run()
+{
+    while (true) {
+        // each chunk is handed over to the queue so it needs its own memory
+        QByteArray chunk;
+        chunk.resize(m_chunkSize);
+
+        qint64 readResult = m_source->read(chunk.data(), m_chunkSize);
+        if (readResult == -1) {
+            m_sink->finishWithError(m_source->errorString());
+            return;
+        }
+        else if (readResult == 0) {
+            m_sink->finish();
+            return;
+        }
+
+        chunk.resize(readResult);
+
+        if (!m_sink->enqueue(chunk)) {
+            return;
+        }
+    }
+}
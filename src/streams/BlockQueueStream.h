@@ -0,0 +1,94 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_BLOCKQUEUESTREAM_H
+#define KEEPASSX_BLOCKQUEUESTREAM_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "core/Global.h"
+
+/**
+ * Read only stream that returns the blocks another thread enqueues.
+ * At most maxBlocks blocks are queued, enqueue() blocks until the reader
+ * catches up. Reads block until enough data is available or the producer
+ * has finished.
+ */
+class BlockQueueStream : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit BlockQueueStream(int maxBlocks, QObject* parent = Q_NULLPTR);
+    ~BlockQueueStream();
+
+    bool isSequential() const Q_DECL_OVERRIDE;
+    bool open(QIODevice::OpenMode mode) Q_DECL_OVERRIDE;
+    bool atEnd() const Q_DECL_OVERRIDE;
+    qint64 bytesAvailable() const Q_DECL_OVERRIDE;
+
+    // called by the producer thread
+    bool enqueue(const QByteArray& block);
+    void finish();
+    void finishWithError(const QString& errorString);
+
+    // called by the consumer to make the producer give up
+    void abort();
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) Q_DECL_OVERRIDE;
+    qint64 writeData(const char* data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private:
+    const int m_maxBlocks;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<QByteArray> m_blocks;
+    int m_blockPos;
+    qint64 m_bytesQueued;
+    bool m_finished;
+    bool m_aborted;
+    bool m_error;
+    QString m_producerErrorString;
+};
+
+/**
+ * Reads a device until its end in chunks of chunkSize bytes
+ * and feeds them into a BlockQueueStream.
+ */
+class BlockQueueFeeder : public QThread
+{
+    Q_OBJECT
+
+public:
+    BlockQueueFeeder(QIODevice* source, BlockQueueStream* sink, int chunkSize);
+
+protected:
+    void run();
+
+private:
+    QIODevice* const m_source;
+    BlockQueueStream* const m_sink;
+    const int m_chunkSize;
+};
+
+#endif // KEEPASSX_BLOCKQUEUESTREAM_H
@@ -19,6 +19,8 @@
 
 #include <cstring>
 
+#include <QtConcurrentRun>
+
 #include "core/Endian.h"
 #include "crypto/CryptoHash.h"
 
@@ -26,14 +28,18 @@ const QSysInfo::Endian HashedBlockStream::ByteOrder = QSysInfo::LittleEndian;
 
 HashedBlockStream::HashedBlockStream(QIODevice* baseDevice)
     : LayeredStream(baseDevice)
+    , m_hash(new CryptoHash(CryptoHash::Sha256))
     , m_blockSize(1024*1024)
+    , m_concurrentBlocks(0)
 {
     init();
 }
 
 HashedBlockStream::HashedBlockStream(QIODevice* baseDevice, qint32 blockSize)
     : LayeredStream(baseDevice)
+    , m_hash(new CryptoHash(CryptoHash::Sha256))
     , m_blockSize(blockSize)
+    , m_concurrentBlocks(0)
 {
     init();
 }
@@ -50,6 +56,20 @@ void HashedBlockStream::init()
     m_blockIndex = 0;
     m_eof = false;
     m_error = false;
+    m_pendingReads.clear();
+    m_pendingReadData.clear();
+    m_freeReadBuffers.clear();
+    m_readAheadDone = false;
+    m_readAheadError = false;
+    m_pendingWriteData.clear();
+    m_pendingWriteHashes.clear();
+}
+
+void HashedBlockStream::setConcurrentBlocks(int blocks)
+{
+    Q_ASSERT(blocks >= 0);
+
+    m_concurrentBlocks = blocks;
 }
 
 bool HashedBlockStream::reset()
@@ -123,58 +143,137 @@ qint64 HashedBlockStream::readData(char* data, qint64 maxSize)
 }
 
 bool HashedBlockStream::readHashedBlock()
+{
+    if (m_concurrentBlocks > 0) {
+        return readHashedBlockConcurrent();
+    }
+
+    char hash[32];
+    bool eof;
+
+    // reuse the block buffer, its size only changes for the last block
+    if (!readBlockData(m_buffer, hash, &eof)) {
+        if (eof) {
+            m_eof = true;
+        }
+        else {
+            m_error = true;
+        }
+        return false;
+    }
+
+    m_hash->reset();
+    m_hash->addData(m_buffer.constData(), m_buffer.size());
+    if (m_hash->result() != QByteArray::fromRawData(hash, 32)) {
+        m_error = true;
+        return false;
+    }
+
+    m_bufferPos = 0;
+
+    return true;
+}
+
+bool HashedBlockStream::readHashedBlockConcurrent()
+{
+    // keep up to m_concurrentBlocks blocks in flight on the thread pool
+    while (!m_readAheadDone && m_pendingReads.size() < m_concurrentBlocks) {
+        // recycle the buffers of consumed blocks so only the first
+        // m_concurrentBlocks + 1 blocks need to be allocated
+        QByteArray data;
+        if (!m_freeReadBuffers.isEmpty()) {
+            data = m_freeReadBuffers.takeLast();
+        }
+        char hash[32];
+        bool eof;
+
+        if (readBlockData(data, hash, &eof)) {
+            m_pendingReadData.enqueue(data);
+            m_pendingReads.enqueue(QtConcurrent::run(verifyBlock, data, QByteArray(hash, 32)));
+        }
+        else {
+            m_readAheadDone = true;
+            m_readAheadError = !eof;
+        }
+    }
+
+    // blocks are delivered in order, errors after the last good block
+    if (m_pendingReads.isEmpty()) {
+        if (m_readAheadError) {
+            m_error = true;
+        }
+        else {
+            m_eof = true;
+        }
+        return false;
+    }
+
+    bool verified = m_pendingReads.dequeue().result();
+
+    if (!m_buffer.isEmpty()) {
+        m_freeReadBuffers.append(m_buffer);
+    }
+    m_buffer = m_pendingReadData.dequeue();
+
+    if (!verified) {
+        m_buffer.clear();
+        m_error = true;
+        return false;
+    }
+
+    m_bufferPos = 0;
+
+    return true;
+}
+
+bool HashedBlockStream::readBlockData(QByteArray& data, char* hash, bool* eof)
 {
     bool ok;
 
+    *eof = false;
+
     quint32 index = Endian::readUInt32(m_baseDevice, ByteOrder, &ok);
     if (!ok || index != m_blockIndex) {
-        m_error = true;
         setErrorString("Invalid block index.");
         return false;
     }
 
-    QByteArray hash = m_baseDevice->read(32);
-    if (hash.size() != 32) {
-        m_error = true;
+    if (m_baseDevice->read(hash, 32) != 32) {
         setErrorString("Invalid hash size.");
         return false;
     }
 
     m_blockSize = Endian::readInt32(m_baseDevice, ByteOrder, &ok);
     if (!ok || m_blockSize < 0) {
-        m_error = true;
         setErrorString("Invalid block size.");
         return false;
     }
 
     if (m_blockSize == 0) {
-        if (hash.count('\0') != 32) {
-            m_error = true;
+        if (QByteArray::fromRawData(hash, 32).count('\0') != 32) {
             return false;
         }
 
-        m_eof = true;
+        *eof = true;
         return false;
     }
 
-    m_buffer = m_baseDevice->read(m_blockSize);
-    if (m_buffer.size() != m_blockSize) {
-        m_error = true;
+    data.resize(m_blockSize);
+    if (m_baseDevice->read(data.data(), m_blockSize) != m_blockSize) {
         setErrorString("Block too short.");
         return false;
     }
 
-    if (hash != CryptoHash::hash(m_buffer, CryptoHash::Sha256)) {
-        m_error = true;
-        return false;
-    }
-
-    m_bufferPos = 0;
     m_blockIndex++;
 
     return true;
 }
 
+bool HashedBlockStream::verifyBlock(const QByteArray& data, const QByteArray& hash)
+{
+    return CryptoHash::hash(data, CryptoHash::Sha256) == hash;
+}
+
 qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -187,6 +286,10 @@ qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
     qint64 offset = 0;
 
     while (bytesRemaining > 0) {
+        if (m_buffer.isEmpty()) {
+            m_buffer.reserve(m_blockSize);
+        }
+
         int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(m_blockSize - m_buffer.size()));
 
         m_buffer.append(data + offset, bytesToCopy);
@@ -211,38 +314,82 @@ qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HashedBlockStream::writeHashedBlock()
 {
-    if (!Endian::writeInt32(m_blockIndex, m_baseDevice, ByteOrder)) {
-        m_error = true;
-        return false;
+    if (m_concurrentBlocks > 0 && !m_buffer.isEmpty()) {
+        // hash on the thread pool, blocks are written in order once their hash is ready
+        m_pendingWriteData.enqueue(m_buffer);
+        m_pendingWriteHashes.enqueue(QtConcurrent::run(hashBlock, m_buffer));
+        m_buffer.clear();
+
+        if (m_pendingWriteData.size() > m_concurrentBlocks) {
+            return writePendingBlock();
+        }
+        else {
+            return true;
+        }
+    }
+
+    while (!m_pendingWriteData.isEmpty()) {
+        if (!writePendingBlock()) {
+            return false;
+        }
     }
-    m_blockIndex++;
 
     QByteArray hash;
     if (!m_buffer.isEmpty()) {
-        hash = CryptoHash::hash(m_buffer, CryptoHash::Sha256);
+        m_hash->reset();
+        m_hash->addData(m_buffer);
+        hash = m_hash->result();
     }
     else {
         hash.fill(0, 32);
     }
 
+    if (!writeBlockData(m_buffer, hash)) {
+        return false;
+    }
+
+    m_buffer.clear();
+
+    return true;
+}
+
+bool HashedBlockStream::writePendingBlock()
+{
+    QByteArray data = m_pendingWriteData.dequeue();
+    QByteArray hash = m_pendingWriteHashes.dequeue().result();
+
+    return writeBlockData(data, hash);
+}
+
+bool HashedBlockStream::writeBlockData(const QByteArray& data, const QByteArray& hash)
+{
+    if (!Endian::writeInt32(m_blockIndex, m_baseDevice, ByteOrder)) {
+        m_error = true;
+        return false;
+    }
+    m_blockIndex++;
+
     if (m_baseDevice->write(hash) != hash.size()) {
         m_error = true;
         return false;
     }
 
-    if (!Endian::writeInt32(m_buffer.size(), m_baseDevice, ByteOrder)) {
+    if (!Endian::writeInt32(data.size(), m_baseDevice, ByteOrder)) {
         m_error = true;
         return false;
     }
 
-    if (!m_buffer.isEmpty()) {
-        if (m_baseDevice->write(m_buffer) != m_buffer.size()) {
+    if (!data.isEmpty()) {
+        if (m_baseDevice->write(data) != data.size()) {
             m_error = true;
             return false;
         }
-
-        m_buffer.clear();
     }
 
     return true;
 }
+
+QByteArray HashedBlockStream::hashBlock(const QByteArray& data)
+{
+    return CryptoHash::hash(data, CryptoHash::Sha256);
+}
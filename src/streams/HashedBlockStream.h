@@ -18,10 +18,15 @@
 #ifndef KEEPASSX_HASHEDBLOCKSTREAM_H
 #define KEEPASSX_HASHEDBLOCKSTREAM_H
 
+#include <QFuture>
+#include <QQueue>
+#include <QScopedPointer>
 #include <QSysInfo>
 
 #include "streams/LayeredStream.h"
 
+class CryptoHash;
+
 class HashedBlockStream : public LayeredStream
 {
     Q_OBJECT
@@ -34,6 +39,15 @@ public:
     bool reset();
     void close();
 
+    /**
+     * Hashes up to the given number of blocks concurrently on the global
+     * thread pool. When reading the stream reads that many blocks ahead,
+     * when writing full blocks are written once their hash has been computed.
+     * 0 (the default) hashes each block on the calling thread.
+     * Has to be set before the stream is used.
+     */
+    void setConcurrentBlocks(int blocks);
+
 protected:
     qint64 readData(char* data, qint64 maxSize) Q_DECL_OVERRIDE;
     qint64 writeData(const char* data, qint64 maxSize) Q_DECL_OVERRIDE;
@@ -41,15 +55,33 @@ protected:
 private:
     void init();
     bool readHashedBlock();
+    bool readHashedBlockConcurrent();
+    bool readBlockData(QByteArray& data, char* hash, bool* eof);
     bool writeHashedBlock();
+    bool writePendingBlock();
+    bool writeBlockData(const QByteArray& data, const QByteArray& hash);
+
+    static bool verifyBlock(const QByteArray& data, const QByteArray& hash);
+    static QByteArray hashBlock(const QByteArray& data);
 
     static const QSysInfo::Endian ByteOrder;
+    const QScopedPointer<CryptoHash> m_hash;
     qint32 m_blockSize;
     QByteArray m_buffer;
     int m_bufferPos;
     quint32 m_blockIndex;
     bool m_eof;
     bool m_error;
+
+    int m_concurrentBlocks;
+    QQueue<QFuture<bool> > m_pendingReads;
+    QQueue<QByteArray> m_pendingReadData;
+    // block buffers that have been consumed and are reused for reading ahead
+    QList<QByteArray> m_freeReadBuffers;
+    bool m_readAheadDone;
+    bool m_readAheadError;
+    QQueue<QByteArray> m_pendingWriteData;
+    QQueue<QFuture<QByteArray> > m_pendingWriteHashes;
 };
 
 #endif // KEEPASSX_HASHEDBLOCKSTREAM_H
@@ -17,15 +17,20 @@
 
 #include "SymmetricCipherStream.h"
 
+const int SymmetricCipherStream::BulkChunkSize = 64 * 1024;
+
 SymmetricCipherStream::SymmetricCipherStream(QIODevice* baseDevice, SymmetricCipher::Algorithm algo,
                                              SymmetricCipher::Mode mode, SymmetricCipher::Direction direction,
-                                             const QByteArray& key, const QByteArray& iv)
+                                             const QByteArray& key, const QByteArray& iv, int chunkSize)
     : LayeredStream(baseDevice)
     , m_cipher(new SymmetricCipher(algo, mode, direction, key, iv))
     , m_bufferPos(0)
     , m_bufferFilling(false)
     , m_error(false)
 {
+    // the chunk always consists of whole cipher blocks
+    int blockSize = m_cipher->blockSize();
+    m_chunkSize = qMax(blockSize, chunkSize - (chunkSize % blockSize));
 }
 
 SymmetricCipherStream::~SymmetricCipherStream()
@@ -96,14 +101,21 @@ qint64 SymmetricCipherStream::readData(char* data, qint64 maxSize)
 
 bool SymmetricCipherStream::readBlock()
 {
-    if (m_bufferFilling) {
-        m_buffer.append(m_baseDevice->read(m_cipher->blockSize() - m_buffer.size()));
-    }
-    else {
-        m_buffer = m_baseDevice->read(m_cipher->blockSize());
+    int blockSize = m_cipher->blockSize();
+    int fillPos = m_bufferFilling ? m_buffer.size() : 0;
+
+    m_buffer.resize(m_chunkSize);
+    qint64 readResult = m_baseDevice->read(m_buffer.data() + fillPos, m_chunkSize - fillPos);
+    if (readResult == -1) {
+        m_error = true;
+        return false;
     }
+    m_buffer.resize(fillPos + readResult);
+
+    bool lastChunk = m_baseDevice->atEnd();
 
-    if (m_buffer.size() != m_cipher->blockSize()) {
+    if (m_buffer.isEmpty() || (m_buffer.size() % blockSize) != 0
+            || (m_buffer.size() != m_chunkSize && !lastChunk)) {
         m_bufferFilling = true;
         return false;
     }
@@ -112,17 +124,17 @@ bool SymmetricCipherStream::readBlock()
         m_bufferPos = 0;
         m_bufferFilling = false;
 
-        if (m_baseDevice->atEnd()) {
+        if (lastChunk) {
             // PKCS7 padding
             quint8 padLength = m_buffer.at(m_buffer.size() - 1);
 
-            if (padLength == m_cipher->blockSize()) {
-                Q_ASSERT(m_buffer == QByteArray(m_cipher->blockSize(), m_cipher->blockSize()));
+            if (padLength == blockSize) {
+                Q_ASSERT(m_buffer.right(blockSize) == QByteArray(blockSize, blockSize));
                 // full block with just padding: discard
-                m_buffer.clear();
-                return false;
+                m_buffer.chop(blockSize);
+                return !m_buffer.isEmpty();
             }
-            else if (padLength > m_cipher->blockSize()) {
+            else if (padLength > blockSize) {
                 // invalid padding
                 m_error = true;
                 return false;
@@ -130,7 +142,7 @@ bool SymmetricCipherStream::readBlock()
             else {
                 Q_ASSERT(m_buffer.right(padLength) == QByteArray(padLength, padLength));
                 // resize buffer to strip padding
-                m_buffer.resize(m_cipher->blockSize() - padLength);
+                m_buffer.chop(padLength);
                 return true;
             }
         }
@@ -152,14 +164,18 @@ qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
     qint64 offset = 0;
 
     while (bytesRemaining > 0) {
-        int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(m_cipher->blockSize() - m_buffer.size()));
+        if (m_buffer.isEmpty()) {
+            m_buffer.reserve(m_chunkSize);
+        }
+
+        int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(m_chunkSize - m_buffer.size()));
 
         m_buffer.append(data + offset, bytesToCopy);
 
         offset += bytesToCopy;
         bytesRemaining -= bytesToCopy;
 
-        if (m_buffer.size() == m_cipher->blockSize()) {
+        if (m_buffer.size() == m_chunkSize) {
             if (!writeBlock(false)) {
                 if (m_error) {
                     return -1;
@@ -178,7 +194,7 @@ bool SymmetricCipherStream::writeBlock(bool lastBlock)
 {
     if (lastBlock) {
         // PKCS7 padding
-        int padLen = m_cipher->blockSize() - m_buffer.size();
+        int padLen = m_cipher->blockSize() - (m_buffer.size() % m_cipher->blockSize());
         for (int i = 0; i < padLen; i++) {
             m_buffer.append(static_cast<char>(padLen));
         }
@@ -29,8 +29,13 @@ class SymmetricCipherStream : public LayeredStream
     Q_OBJECT
 
 public:
+    // Processing more than one cipher block per call is much faster but
+    // delays writes to the base device until a whole chunk is filled.
+    static const int BulkChunkSize;
+
     SymmetricCipherStream(QIODevice* baseDevice, SymmetricCipher::Algorithm algo, SymmetricCipher::Mode mode,
-                          SymmetricCipher::Direction direction, const QByteArray& key, const QByteArray& iv);
+                          SymmetricCipher::Direction direction, const QByteArray& key, const QByteArray& iv,
+                          int chunkSize = 0);
     ~SymmetricCipherStream();
     bool reset();
     void close();
@@ -44,6 +49,7 @@ private:
     bool writeBlock(bool lastBlock);
 
     const QScopedPointer<SymmetricCipher> m_cipher;
+    int m_chunkSize;
     QByteArray m_buffer;
     int m_bufferPos;
     bool m_bufferFilling;
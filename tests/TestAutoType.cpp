@@ -22,12 +22,15 @@
 
 #include "tests.h"
 #include "core/Config.h"
+#include "core/Database.h"
 #include "core/FilePath.h"
 #include "core/Entry.h"
 #include "core/Group.h"
 #include "crypto/Crypto.h"
 #include "autotype/AutoType.h"
+#include "autotype/AutoTypeMatchIndex.h"
 #include "autotype/AutoTypePlatformPlugin.h"
+#include "autotype/WindowPatternCache.h"
 #include "autotype/test/AutoTypeTestInterface.h"
 #include "gui/MessageBox.h"
 
@@ -156,3 +159,154 @@ void TestAutoType::testGlobalAutoTypeTitleMatchDisabled()
     QCOMPARE(m_test->actionChars(), QString());
 
 }
+
+void TestAutoType::testGlobalAutoTypeModifiedAssociation()
+{
+    m_test->setActiveWindowTitle("custom window");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(),
+             QString("%1association%2")
+             .arg(m_entry1->username())
+             .arg(m_entry1->password()));
+
+    // the compiled patterns have to be updated
+    AutoTypeAssociations::Association association;
+    association.window = "//other W.NDOW( \\d+)?//";
+    association.sequence = "{username}regexp{password}";
+    m_entry1->autoTypeAssociations()->update(0, association);
+
+    m_test->clearActions();
+    m_test->setActiveWindowTitle("Other window 42");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(),
+             QString("%1regexp%2")
+             .arg(m_entry1->username())
+             .arg(m_entry1->password()));
+
+    m_test->clearActions();
+    m_test->setActiveWindowTitle("custom window");
+    MessageBox::setNextAnswer(QMessageBox::Ok);
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString());
+
+    m_entry1->autoTypeAssociations()->clear();
+    association.window = "custom*";
+    association.sequence = "{username}wildcard{password}";
+    m_entry1->autoTypeAssociations()->add(association);
+
+    m_test->clearActions();
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(),
+             QString("%1wildcard%2")
+             .arg(m_entry1->username())
+             .arg(m_entry1->password()));
+}
+
+void TestAutoType::testMatchIndex()
+{
+    Database* db = new Database();
+    Group* root = db->rootGroup();
+    AutoTypeAssociations::Association association;
+
+    // the first association without a sequence has precedence but there is
+    // nothing to type
+    Entry* entryNoSequence = new Entry();
+    entryNoSequence->setGroup(root);
+    association.window = "Literal Window";
+    entryNoSequence->autoTypeAssociations()->add(association);
+    association.window = "*";
+    association.sequence = "{unused}";
+    entryNoSequence->autoTypeAssociations()->add(association);
+
+    Entry* entryUnanchored = new Entry();
+    entryUnanchored->setGroup(root);
+    entryUnanchored->setUsername("user");
+    association.window = "*ral*";
+    association.sequence = "";
+    entryUnanchored->autoTypeAssociations()->add(association);
+
+    Group* groupA = new Group();
+    groupA->setParent(root);
+    groupA->setDefaultAutoTypeSequence("{groupA}");
+
+    Entry* entryLiteral = new Entry();
+    entryLiteral->setGroup(groupA);
+    association.window = "literal window";
+    association.sequence = "";
+    entryLiteral->autoTypeAssociations()->add(association);
+    association.window = "lit*";
+    association.sequence = "{prefix}";
+    entryLiteral->autoTypeAssociations()->add(association);
+
+    Entry* entrySuffix = new Entry();
+    entrySuffix->setGroup(groupA);
+    association.window = "*WINDOW";
+    association.sequence = "{suffix}";
+    entrySuffix->autoTypeAssociations()->add(association);
+
+    Entry* entryTitle = new Entry();
+    entryTitle->setGroup(groupA);
+    entryTitle->setTitle("Literal");
+
+    Group* groupB = new Group();
+    groupB->setParent(root);
+    groupB->setAutoTypeEnabled(Group::Disable);
+
+    Entry* entryDisabled = new Entry();
+    entryDisabled->setGroup(groupB);
+    association.window = "Literal Window";
+    association.sequence = "{disabled}";
+    entryDisabled->autoTypeAssociations()->add(association);
+
+    Group* groupC = new Group();
+    groupC->setParent(groupB);
+    groupC->setAutoTypeEnabled(Group::Enable);
+
+    Entry* entryRegExp = new Entry();
+    entryRegExp->setGroup(groupC);
+    association.window = "//lit.* w[a-z]+//";
+    association.sequence = "{regexp}";
+    entryRegExp->autoTypeAssociations()->add(association);
+
+    WindowPatternCache patternCache;
+    AutoTypeMatchIndex index(&patternCache);
+    index.setDatabases(QList<Database*>() << db);
+
+    QList<AutoTypeMatchIndex::Match> matches = index.match("Literal Window", false);
+    QCOMPARE(matches.size(), 4);
+    QCOMPARE(matches[0].entry, entryUnanchored);
+    QCOMPARE(matches[0].sequence, QString("{USERNAME}{ENTER}"));
+    QCOMPARE(matches[1].entry, entryLiteral);
+    QCOMPARE(matches[1].sequence, QString("{groupA}"));
+    QCOMPARE(matches[2].entry, entrySuffix);
+    QCOMPARE(matches[2].sequence, QString("{suffix}"));
+    QCOMPARE(matches[3].entry, entryRegExp);
+    QCOMPARE(matches[3].sequence, QString("{regexp}"));
+
+    matches = index.match("Literal Window", true);
+    QCOMPARE(matches.size(), 5);
+    QCOMPARE(matches[3].entry, entryTitle);
+    QCOMPARE(matches[3].sequence, QString("{groupA}"));
+
+    matches = index.match("Some window", false);
+    QCOMPARE(matches.size(), 2);
+    QCOMPARE(matches[0].entry, entryNoSequence);
+    QCOMPARE(matches[0].sequence, QString("{unused}"));
+    QCOMPARE(matches[1].entry, entrySuffix);
+
+    QVERIFY(index.match("nomatch", true).isEmpty());
+
+    // modifications of the database rebuild the index
+    groupB->setAutoTypeEnabled(Group::Inherit);
+    entryLiteral->autoTypeAssociations()->remove(0);
+    matches = index.match("Literal Window", false);
+    QCOMPARE(matches.size(), 5);
+    QCOMPARE(matches[1].entry, entryLiteral);
+    QCOMPARE(matches[1].sequence, QString("{prefix}"));
+    QCOMPARE(matches[3].entry, entryDisabled);
+    QCOMPARE(matches[3].sequence, QString("{disabled}"));
+
+    delete db;
+    QVERIFY(index.match("Literal Window", false).isEmpty());
+    QCOMPARE(patternCache.count(), 0);
+}
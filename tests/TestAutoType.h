@@ -43,6 +43,8 @@ private Q_SLOTS:
     void testGlobalAutoTypeWithOneMatch();
     void testGlobalAutoTypeTitleMatch();
     void testGlobalAutoTypeTitleMatchDisabled();
+    void testGlobalAutoTypeModifiedAssociation();
+    void testMatchIndex();
 
 private:
     AutoTypePlatformInterface* m_platform;
@@ -17,12 +17,47 @@
 
 #include "TestEntry.h"
 
+#include <QFile>
+#include <QScopedPointer>
+#include <QSignalSpy>
 #include <QTest>
 
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
 #include "tests.h"
+#include "core/AttachmentPool.h"
+#include "core/Database.h"
 #include "core/Entry.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
 #include "crypto/Crypto.h"
 
+namespace {
+
+// resident set size of the test process in kB, -1 if unknown
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+#else
+    return -1;
+#endif
+}
+
+}
+
 QTEST_GUILESS_MAIN(TestEntry)
 
 void TestEntry::initTestCase()
@@ -123,3 +158,180 @@ void TestEntry::testClone()
     QCOMPARE(entryCloneHistory->historyItems().first()->title(), QString("Original Title"));
     QCOMPARE(entryCloneHistory->timeInfo().creationTime(), entryOrg->timeInfo().creationTime());
 }
+
+void TestEntry::testSharedAttachments()
+{
+    int poolCount = attachmentPool()->count();
+    QByteArray data("attachment data");
+
+    Entry* entry1 = new Entry();
+    entry1->attachments()->set("a", data);
+    entry1->attachments()->set("b", data);
+    QCOMPARE(attachmentPool()->count(), poolCount + 1);
+
+    int poolKey = entry1->attachments()->poolKey("a");
+    QCOMPARE(entry1->attachments()->poolKey("b"), poolKey);
+    QCOMPARE(attachmentPool()->refCount(poolKey), 2);
+
+    // equal data from a different source is shared as well
+    Entry* entry2 = new Entry();
+    entry2->attachments()->set("c", QByteArray("attachment ") + QByteArray("data"));
+    QCOMPARE(entry2->attachments()->poolKey("c"), poolKey);
+    QCOMPARE(attachmentPool()->refCount(poolKey), 3);
+
+    Entry* clone = entry1->clone(Entry::CloneNoFlags);
+    QCOMPARE(attachmentPool()->refCount(poolKey), 5);
+    QCOMPARE(clone->attachments()->value("a"), data);
+
+    entry1->attachments()->set("a", QByteArray("other data"));
+    QCOMPARE(attachmentPool()->count(), poolCount + 2);
+    QCOMPARE(attachmentPool()->refCount(poolKey), 4);
+    QCOMPARE(entry1->attachments()->value("a"), QByteArray("other data"));
+
+    entry1->attachments()->remove("b");
+    QCOMPARE(attachmentPool()->refCount(poolKey), 3);
+
+    delete clone;
+    QCOMPARE(attachmentPool()->refCount(poolKey), 1);
+
+    entry2->attachments()->clear();
+    QCOMPARE(attachmentPool()->refCount(poolKey), 0);
+    QCOMPARE(attachmentPool()->count(), poolCount + 1);
+
+    delete entry1;
+    delete entry2;
+    QCOMPARE(attachmentPool()->count(), poolCount);
+}
+
+void TestEntry::testLazyChildObjects()
+{
+    Entry* entry = new Entry();
+    const Entry* constEntry = entry;
+
+    // only EntryAttributes is created up front
+    QCOMPARE(entry->children().size(), 1);
+    QCOMPARE(constEntry->attachments()->keys().size(), 0);
+    QCOMPARE(constEntry->autoTypeAssociations()->size(), 0);
+    QCOMPARE(entry->children().size(), 1);
+
+    entry->beginUpdate();
+    entry->setTitle("title");
+    entry->endUpdate();
+    QCOMPARE(entry->historyItems().size(), 1);
+    QCOMPARE(entry->historyItems().at(0)->children().size(), 1);
+
+    QSignalSpy spyModified(entry, SIGNAL(modified()));
+    entry->attachments()->set("a", QByteArray("data"));
+    QCOMPARE(spyModified.count(), 1);
+    AutoTypeAssociations::Association assoc;
+    assoc.window = "window";
+    entry->autoTypeAssociations()->add(assoc);
+    QCOMPARE(spyModified.count(), 2);
+    QCOMPARE(entry->children().size(), 3);
+
+    Entry* entry2 = new Entry();
+    entry2->copyDataFrom(entry);
+    QCOMPARE(static_cast<const Entry*>(entry2)->attachments()->value("a"), QByteArray("data"));
+    QCOMPARE(static_cast<const Entry*>(entry2)->autoTypeAssociations()->size(), 1);
+
+    // copying from an entry without attachments clears them
+    Entry* entry3 = new Entry();
+    entry2->copyDataFrom(entry3);
+    QCOMPARE(static_cast<const Entry*>(entry2)->attachments()->keys().size(), 0);
+    QCOMPARE(static_cast<const Entry*>(entry2)->autoTypeAssociations()->size(), 0);
+    QCOMPARE(entry3->children().size(), 1);
+
+    delete entry;
+    delete entry2;
+    delete entry3;
+}
+
+void TestEntry::testHistorySnapshots()
+{
+    int poolCount = attachmentPool()->count();
+
+    Entry* entry = new Entry();
+    entry->attachments()->set("a", QByteArray("history data"));
+    entry->beginUpdate();
+    entry->setTitle("title");
+    entry->attachments()->remove("a");
+    entry->endUpdate();
+
+    // the history item keeps the attachment
+    QCOMPARE(attachmentPool()->count(), poolCount + 1);
+    QCOMPARE(entry->historySnapshots().size(), 1);
+    QCOMPARE(entry->historySnapshots().at(0).attachments.size(), 1);
+    QCOMPARE(entry->historySnapshots().at(0).attributes.value(EntryAttributes::TitleKey), QString());
+
+    Entry* historyItem = entry->historyItems().at(0);
+    QCOMPARE(historyItem->title(), QString());
+    QCOMPARE(historyItem->attachments()->value("a"), QByteArray("history data"));
+    QCOMPARE(entry->historyItems().at(0), historyItem);
+
+    Entry* clone = entry->clone(Entry::CloneNewUuid | Entry::CloneIncludeHistory);
+    QCOMPARE(clone->historySnapshots().size(), 1);
+    QCOMPARE(clone->historySnapshots().at(0).uuid, clone->uuid());
+    QCOMPARE(clone->historyItems().at(0)->attachments()->value("a"), QByteArray("history data"));
+    delete clone;
+
+    entry->removeHistoryItems(QList<Entry*>() << historyItem);
+    QCOMPARE(entry->historySnapshots().size(), 0);
+    QCOMPARE(entry->historyItems().size(), 0);
+    QCOMPARE(attachmentPool()->count(), poolCount);
+
+    delete entry;
+}
+
+void TestEntry::benchmarkHistoryMemory()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    if (residentMemory() < 0) {
+        QSKIP("Resident memory can't be measured on this platform.", SkipAll);
+    }
+
+    const int entryCount = 100000;
+    const int historyCount = 10;
+
+    qint64 before = residentMemory();
+
+    QScopedPointer<Database> db(new Database());
+    db->metadata()->setHistoryMaxItems(-1);
+    db->metadata()->setHistoryMaxSize(-1);
+    QList<Entry*> entries;
+
+    for (int i = 0; i < entryCount; i++) {
+        Entry* entry = new Entry();
+        entry->setUsername(QString("user%1@example.com").arg(i));
+        entry->setUrl(QString("https://www.site%1.example.com/login").arg(i));
+        entry->setGroup(db->rootGroup());
+        entries.append(entry);
+
+        for (int j = 0; j < historyCount; j++) {
+            entry->beginUpdate();
+            entry->setTitle(QString("Entry %1-%2").arg(i).arg(j));
+            entry->setPassword(QString("password %1-%2").arg(i).arg(j));
+            entry->endUpdate();
+        }
+    }
+
+    qint64 snapshots = residentMemory();
+
+    // creates an Entry object for every history item, like all history
+    // items were stored before
+    Q_FOREACH (const Entry* entry, entries) {
+        QCOMPARE(entry->historyItems().size(), historyCount);
+    }
+
+    qint64 historyEntries = residentMemory();
+
+    qDebug("%d entries with %d history items each: %lld kB with snapshots, %lld kB more with Entry objects",
+           entryCount, historyCount, snapshots - before, historyEntries - snapshots);
+
+    // the snapshots have to stay below the Entry objects they replace
+    QVERIFY(snapshots - before < historyEntries - snapshots);
+}
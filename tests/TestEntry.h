@@ -31,6 +31,10 @@ private Q_SLOTS:
     void testHistoryItemDeletion();
     void testCopyDataFrom();
     void testClone();
+    void testSharedAttachments();
+    void testLazyChildObjects();
+    void testHistorySnapshots();
+    void benchmarkHistoryMemory();
 };
 
 #endif // KEEPASSX_TESTENTRY_H
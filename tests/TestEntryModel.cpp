@@ -25,6 +25,7 @@
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Group.h"
+#include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "gui/IconModels.h"
 #include "gui/SortFilterHideProxyModel.h"
@@ -343,3 +344,350 @@ void TestEntryModel::testDatabaseDelete()
     delete modelTest;
     delete model;
 }
+
+void TestEntryModel::testRemoveEntries()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database* db = new Database();
+    Group* group = db->rootGroup();
+
+    QList<Entry*> entries;
+    for (int i = 0; i < 10; i++) {
+        Entry* entry = new Entry();
+        entry->setGroup(group);
+        entries.append(entry);
+    }
+
+    model->setGroup(group);
+    QCOMPARE(model->indexFromEntry(entries[9]).row(), 9);
+
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    QList<Entry*> removedEntries;
+    removedEntries << entries[6] << entries[2] << entries[9] << entries[1] << entries[3];
+    model->removeEntries(removedEntries);
+    Q_FOREACH (Entry* entry, removedEntries) {
+        entries.removeOne(entry);
+        delete entry;
+    }
+
+    // one signal per contiguous block
+    QCOMPARE(spyRemoved.size(), 3);
+    QCOMPARE(spyRemoved[0][1].toInt(), 9);
+    QCOMPARE(spyRemoved[0][2].toInt(), 9);
+    QCOMPARE(spyRemoved[1][1].toInt(), 6);
+    QCOMPARE(spyRemoved[1][2].toInt(), 6);
+    QCOMPARE(spyRemoved[2][1].toInt(), 1);
+    QCOMPARE(spyRemoved[2][2].toInt(), 3);
+
+    QCOMPARE(model->rowCount(), 5);
+    for (int i = 0; i < entries.size(); i++) {
+        QCOMPARE(model->indexFromEntry(entries[i]).row(), i);
+        QCOMPARE(model->entryFromIndex(model->index(i, 0)), entries[i]);
+    }
+
+    // the rows are updated when entries are removed or added one by one
+    model->setEntryList(entries);
+    delete entries.takeAt(1);
+    QCOMPARE(model->rowCount(), 4);
+    QCOMPARE(model->indexFromEntry(entries[3]).row(), 3);
+
+    model->setGroup(group);
+    Entry* entry = new Entry();
+    entry->setGroup(group);
+    entries.append(entry);
+    delete entries.takeAt(0);
+    QCOMPARE(model->rowCount(), 4);
+    for (int i = 0; i < entries.size(); i++) {
+        QCOMPARE(model->indexFromEntry(entries[i]).row(), i);
+    }
+
+    delete modelTest;
+    delete model;
+    delete db;
+}
+
+void TestEntryModel::testBatchUpdate()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database* db = new Database();
+    Group* group = db->rootGroup();
+    Group* group2 = new Group();
+    group2->setParent(group);
+
+    QList<Entry*> entries;
+    for (int i = 0; i < 10; i++) {
+        Entry* entry = new Entry();
+        entry->setGroup(group);
+        entries.append(entry);
+    }
+
+    model->setGroup(group);
+
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    QSignalSpy spyInserted(model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    QSignalSpy spyModified(db, SIGNAL(modifiedImmediate()));
+
+    db->beginBatchUpdate();
+    QVERIFY(db->isBatchUpdating());
+    for (int i = 0; i < 5; i++) {
+        entries.takeFirst()->setGroup(group2);
+    }
+    db->beginBatchUpdate();
+    delete entries.takeFirst();
+    db->endBatchUpdate();
+    Entry* entry = new Entry();
+    entry->setGroup(group);
+    entries.append(entry);
+    entries[0]->setTitle("changed");
+    QCOMPARE(spyModified.size(), 0);
+    db->endBatchUpdate();
+    QVERIFY(!db->isBatchUpdating());
+
+    QCOMPARE(spyModified.size(), 1);
+    QCOMPARE(spyReset.size(), 1);
+    QCOMPARE(spyInserted.size(), 0);
+    QCOMPARE(spyRemoved.size(), 0);
+    QCOMPARE(spyDataChanged.size(), 0);
+
+    QCOMPARE(model->rowCount(), 5);
+    for (int i = 0; i < entries.size(); i++) {
+        QCOMPARE(model->indexFromEntry(entries[i]).row(), i);
+        QCOMPARE(model->entryFromIndex(model->index(i, 0)), entries[i]);
+    }
+
+    // changes that don't add or remove rows don't reset the model
+    db->beginBatchUpdate();
+    entries[1]->setTitle("changed");
+    entries[2]->setTitle("changed");
+    group2->entries().first()->setTitle("changed");
+    db->endBatchUpdate();
+
+    QCOMPARE(spyModified.size(), 2);
+    QCOMPARE(spyReset.size(), 1);
+    QCOMPARE(spyDataChanged.size(), 1);
+
+    // no notifications for empty batches
+    db->beginBatchUpdate();
+    db->endBatchUpdate();
+    QCOMPARE(spyModified.size(), 2);
+    QCOMPARE(spyReset.size(), 1);
+    QCOMPARE(spyDataChanged.size(), 1);
+
+    delete modelTest;
+    delete model;
+    delete db;
+}
+
+void TestEntryModel::testEntryListChanges()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database* db = new Database();
+    db->metadata()->setRecycleBinEnabled(true);
+    Group* group1 = new Group();
+    group1->setParent(db->rootGroup());
+
+    Entry* entry1 = new Entry();
+    entry1->setGroup(group1);
+    Entry* entry2 = new Entry();
+    entry2->setGroup(group1);
+    Entry* entry3 = new Entry();
+    entry3->setGroup(db->rootGroup());
+
+    model->setEntryList(QList<Entry*>() << entry1 << entry2);
+    QCOMPARE(model->rowCount(), 2);
+
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    entry2->setTitle("changed");
+    QCOMPARE(spyDataChanged.size(), 1);
+    entry3->setTitle("changed");
+    QCOMPARE(spyDataChanged.size(), 1);
+
+    // groups created after the search are followed as well
+    Group* group2 = new Group();
+    group2->setParent(db->rootGroup());
+    entry1->setGroup(group2);
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(model->entryFromIndex(model->index(1, 0)), entry1);
+    entry1->setTitle("changed");
+    QCOMPARE(spyDataChanged.size(), 2);
+
+    // entries that aren't part of the result aren't added
+    entry3->setGroup(group2);
+    QCOMPARE(model->rowCount(), 2);
+
+    db->recycleEntry(entry2);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->entryFromIndex(model->index(0, 0)), entry1);
+
+    // deleting an entry inside the recycle bin is noticed as well
+    model->setEntryList(QList<Entry*>() << entry1 << entry2);
+    QCOMPARE(model->rowCount(), 2);
+    delete entry2;
+    QCOMPARE(model->rowCount(), 1);
+
+    delete db;
+    QCOMPARE(model->rowCount(), 0);
+
+    model->setEntryList(QList<Entry*>());
+    QCOMPARE(model->rowCount(), 0);
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testFetchMore()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database* db = new Database();
+    Group* group = db->rootGroup();
+
+    const int entryCount = EntryModel::FetchBatchSize + 500;
+    QList<Entry*> entries;
+    for (int i = 0; i < entryCount; i++) {
+        Entry* entry = new Entry();
+        entry->setGroup(group);
+        entries.append(entry);
+    }
+
+    model->setEntryList(entries);
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize);
+    QVERIFY(model->canFetchMore(QModelIndex()));
+    QVERIFY(!model->indexFromEntry(entries.last()).isValid());
+
+    QSignalSpy spyInserted(model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // rows that haven't been fetched are removed without notification
+    delete entries.takeLast();
+    QCOMPARE(spyRemoved.size(), 0);
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize);
+
+    model->fetchMore(QModelIndex());
+    QCOMPARE(spyInserted.size(), 1);
+    QCOMPARE(spyInserted[0][1].toInt(), EntryModel::FetchBatchSize);
+    QCOMPARE(spyInserted[0][2].toInt(), entryCount - 2);
+    QCOMPARE(model->rowCount(), entryCount - 1);
+    QVERIFY(!model->canFetchMore(QModelIndex()));
+    QCOMPARE(model->indexFromEntry(entries.last()).row(), entryCount - 2);
+
+    delete entries.takeFirst();
+    QCOMPARE(spyRemoved.size(), 1);
+    QCOMPARE(model->rowCount(), entryCount - 2);
+
+    // appended results are fetched by the view once the first batch is full
+    model->setEntryList(entries.mid(0, 10));
+    model->appendEntryList(entries.mid(10, EntryModel::FetchBatchSize));
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize);
+    QVERIFY(model->canFetchMore(QModelIndex()));
+    model->fetchMore(QModelIndex());
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize + 10);
+
+    // unfetched rows removed during a batch update don't leave empty rows
+    model->setEntryList(entries);
+    db->beginBatchUpdate();
+    delete entries.takeLast();
+    delete entries.takeFirst();
+    db->endBatchUpdate();
+    while (model->canFetchMore(QModelIndex())) {
+        model->fetchMore(QModelIndex());
+    }
+    QCOMPARE(model->rowCount(), entries.size());
+    for (int row = 0; row < model->rowCount(); row++) {
+        QCOMPARE(model->entryFromIndex(model->index(row, 1)), entries.at(row));
+    }
+
+    // with a fetch order the rows are fetched sorted like the view shows them
+    for (int i = 0; i < entries.size(); i++) {
+        entries.at(i)->setTitle(QString("entry %1").arg(i, 4, 10, QChar('0')));
+    }
+    QList<Entry*> reversed;
+    Q_FOREACH (Entry* entry, entries) {
+        reversed.prepend(entry);
+    }
+
+    model->setFetchOrder(EntryModel::Title, Qt::AscendingOrder);
+    model->setEntryList(reversed.mid(1));
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize);
+    QVERIFY(model->canFetchMore(QModelIndex()));
+    QCOMPARE(model->entryFromIndex(model->index(0, 1)), entries.first());
+
+    // appended results sorted behind the fetched rows are fetched by the view
+    spyInserted.clear();
+    model->appendEntryList(QList<Entry*>() << entries.last());
+    QCOMPARE(spyInserted.size(), 0);
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize);
+
+    // appended results sorted in between them are shown right away
+    Entry* entry = new Entry();
+    entry->setTitle("entry 0000a");
+    entry->setGroup(group);
+    model->appendEntryList(QList<Entry*>() << entry);
+    QCOMPARE(spyInserted.size(), 1);
+    QCOMPARE(spyInserted[0][1].toInt(), 1);
+    QCOMPARE(model->entryFromIndex(model->index(1, 1)), entry);
+    QCOMPARE(model->rowCount(), EntryModel::FetchBatchSize + 1);
+    entries.insert(1, entry);
+
+    while (model->canFetchMore(QModelIndex())) {
+        model->fetchMore(QModelIndex());
+    }
+    QCOMPARE(model->rowCount(), entries.size());
+    for (int row = 0; row < model->rowCount(); row++) {
+        QCOMPARE(model->entryFromIndex(model->index(row, 1)), entries.at(row));
+    }
+
+    model->setFetchOrder(EntryModel::Title, Qt::DescendingOrder);
+    QCOMPARE(model->rowCount(), entries.size());
+    for (int row = 0; row < model->rowCount(); row++) {
+        QCOMPARE(model->entryFromIndex(model->index(row, 1)), entries.at(entries.size() - 1 - row));
+    }
+
+    delete modelTest;
+    delete model;
+    delete db;
+}
+
+void TestEntryModel::testExpiredDisplay()
+{
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+
+    Database* db = new Database();
+    Entry* entry = new Entry();
+    entry->setGroup(db->rootGroup());
+    entry->setTitle("title");
+    entry->setExpiryTime(QDateTime::currentDateTime().toUTC().addDays(-1));
+
+    model->setGroup(db->rootGroup());
+    QModelIndex index = model->index(0, EntryModel::Title);
+    QCOMPARE(model->data(index).toString(), QString("title"));
+    QVERIFY(!model->data(index, Qt::FontRole).value<QFont>().strikeOut());
+
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    entry->setExpires(true);
+    QCOMPARE(spyDataChanged.size(), 1);
+    QVERIFY(model->data(index, Qt::FontRole).value<QFont>().strikeOut());
+
+    entry->setTitle("changed");
+    QCOMPARE(spyDataChanged.size(), 2);
+    QCOMPARE(model->data(index).toString(), QString("changed"));
+
+    entry->setExpiryTime(QDateTime::currentDateTime().toUTC().addDays(1));
+    QCOMPARE(spyDataChanged.size(), 3);
+    QVERIFY(!model->data(index, Qt::FontRole).value<QFont>().strikeOut());
+
+    delete modelTest;
+    delete model;
+    delete db;
+}
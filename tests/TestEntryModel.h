@@ -34,6 +34,11 @@ private Q_SLOTS:
     void testAutoTypeAssociationsModel();
     void testProxyModel();
     void testDatabaseDelete();
+    void testRemoveEntries();
+    void testBatchUpdate();
+    void testEntryListChanges();
+    void testFetchMore();
+    void testExpiredDisplay();
 };
 
 #endif // KEEPASSX_TESTENTRYMODEL_H
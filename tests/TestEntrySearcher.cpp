@@ -17,14 +17,20 @@
 
 #include "TestEntrySearcher.h"
 
+#include <QSignalSpy>
 #include <QTest>
 
 #include "tests.h"
+#include "core/Database.h"
+#include "core/ParallelEntryFilter.h"
+#include "crypto/Crypto.h"
 
 QTEST_GUILESS_MAIN(TestEntrySearcher)
 
 void TestEntrySearcher::initTestCase()
 {
+    QVERIFY(Crypto::init());
+
     m_groupRoot = new Group();
 }
 
@@ -142,3 +148,260 @@ void TestEntrySearcher::testAllAttributesAreSearched()
     m_searchResult = m_entrySearcher.search("testTitle testUsername testUrl testNote", m_groupRoot, Qt::CaseInsensitive);
     QCOMPARE(m_searchResult.count(), 1);
 }
+
+void TestEntrySearcher::testIndexedSearch()
+{
+    QScopedPointer<Database> db(new Database());
+    Group* root = db->rootGroup();
+
+    Group* group1 = new Group();
+    group1->setParent(root);
+    Group* group2 = new Group();
+    group2->setParent(root);
+    group2->setSearchingEnabled(Group::Disable);
+
+    Entry* entry1 = new Entry();
+    entry1->setTitle("Example Title");
+    entry1->setUsername("user");
+    entry1->setGroup(group1);
+
+    Entry* entry2 = new Entry();
+    entry2->setUrl("http://example.com");
+    entry2->setNotes("first line\nsecond line");
+    entry2->setGroup(root);
+
+    Entry* entry3 = new Entry();
+    entry3->setTitle("example");
+    entry3->setGroup(group2);
+
+    m_searchResult = m_entrySearcher.search("example", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry2 << entry1);
+
+    m_searchResult = m_entrySearcher.search("Example", root, Qt::CaseSensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry1);
+
+    m_searchResult = m_entrySearcher.search("e", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry2 << entry1);
+
+    m_searchResult = m_entrySearcher.search("ex le", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry2 << entry1);
+
+    m_searchResult = m_entrySearcher.search("example user", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry1);
+
+    // words must not match across fields
+    m_searchResult = m_entrySearcher.search("titleuser", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult.size(), 0);
+
+    m_searchResult = m_entrySearcher.search("example", group2, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult.size(), 0);
+
+    // changes are picked up by the index
+    entry1->setTitle("Something else");
+    m_searchResult = m_entrySearcher.search("example", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry2);
+    m_searchResult = m_entrySearcher.search("something", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry1);
+
+    entry3->setGroup(group1);
+    m_searchResult = m_entrySearcher.search("example", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry2 << entry3);
+
+    delete entry2;
+    m_searchResult = m_entrySearcher.search("example", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry3);
+
+    Entry* entry4 = new Entry();
+    entry4->setNotes("another example");
+    entry4->setGroup(group1);
+    m_searchResult = m_entrySearcher.search("example", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry3 << entry4);
+
+    // entries moved to a database without an index entry
+    QScopedPointer<Database> db2(new Database());
+    entry4->setGroup(db2->rootGroup());
+    m_searchResult = m_entrySearcher.search("example", root, Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry3);
+    m_searchResult = m_entrySearcher.search("example", db2->rootGroup(), Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult, QList<Entry*>() << entry4);
+}
+
+void TestEntrySearcher::testAsyncSearch()
+{
+    QScopedPointer<Database> db(new Database());
+    Group* group1 = new Group();
+    group1->setParent(db->rootGroup());
+    Group* group2 = new Group();
+    group2->setParent(db->rootGroup());
+    Group* group3 = new Group();
+    group3->setParent(db->rootGroup());
+    group3->setSearchingEnabled(Group::Disable);
+
+    QList<Entry*> expected;
+    for (int i = 0; i < 600; i++) {
+        Entry* entry = new Entry();
+        entry->setTitle(QString("entry %1").arg(i));
+        entry->setUsername(i % 2 == 0 ? "even" : "odd");
+        entry->setGroup(i < 300 ? group1 : (i < 500 ? group2 : group3));
+        if (i < 500) {
+            expected.append(entry);
+        }
+    }
+
+    AsyncEntrySearcher searcher;
+    connect(&searcher, SIGNAL(entriesFound(QList<Entry*>)), SLOT(collectEntries(QList<Entry*>)));
+    QSignalSpy batchSpy(&searcher, SIGNAL(entriesFound(QList<Entry*>)));
+    QSignalSpy finishedSpy(&searcher, SIGNAL(searchFinished()));
+
+    // results arrive in batches and in tree order
+    m_searchResult.clear();
+    searcher.search("entry", db->rootGroup(), Qt::CaseInsensitive);
+    QVERIFY(searcher.isRunning());
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QVERIFY(!searcher.isRunning());
+    QCOMPARE(batchSpy.count(), 2);
+    QCOMPARE(m_searchResult, expected);
+
+    // a new search cancels the running one
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("entry", db->rootGroup(), Qt::CaseInsensitive);
+    searcher.search("ENTRY 1", group1, Qt::CaseSensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult.size(), 0);
+
+    // refining the previous result
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("entry 1", group1, Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult.size(), 111);
+
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("entry 1 even", group1, Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult.size(), 55);
+
+    // entries outside of the previous result aren't matched again
+    expected.at(2)->setTitle("entry 10 x");
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("entry 10 even", group1, Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult.size(), 8);
+    QVERIFY(!m_searchResult.contains(expected.at(2)));
+
+    // reset() drops the snapshot
+    expected.at(0)->setTitle("something else");
+    searcher.reset();
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("something", db->rootGroup(), Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult, QList<Entry*>() << expected.at(0));
+
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("entry 10 even", group1, Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult.size(), 9);
+    QVERIFY(m_searchResult.contains(expected.at(2)));
+
+    // an empty term matches everything and isn't refined
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("", db->rootGroup(), Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult, expected);
+
+    m_searchResult.clear();
+    finishedSpy.clear();
+    searcher.search("entry 499", db->rootGroup(), Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult, QList<Entry*>() << expected.at(499));
+}
+
+void TestEntrySearcher::collectEntries(const QList<Entry*>& entries)
+{
+    m_searchResult.append(entries);
+}
+
+void TestEntrySearcher::testParallelSearch()
+{
+    // groups without a database are scanned, spread the entries over
+    // enough chunks to use several threads
+    Group* root = new Group();
+    QList<Entry*> expected;
+
+    for (int i = 0; i < 10; i++) {
+        Group* group = new Group();
+        group->setParent(root);
+        if (i == 3) {
+            group->setSearchingEnabled(Group::Disable);
+        }
+
+        for (int j = 0; j < ParallelEntryFilter::MinChunkSize; j++) {
+            Entry* entry = new Entry();
+            entry->setTitle(QString("entry %1 %2").arg(i).arg(j));
+            entry->setGroup(group);
+
+            if (i != 3 && (j % 7) == 0) {
+                entry->setNotes("match");
+                expected.append(entry);
+            }
+        }
+    }
+
+    EntrySearcher searcher;
+    QCOMPARE(searcher.search("MATCH", root, Qt::CaseInsensitive), expected);
+    QCOMPARE(searcher.search("MATCH", root, Qt::CaseSensitive), QList<Entry*>());
+
+    AsyncEntrySearcher asyncSearcher;
+    connect(&asyncSearcher, SIGNAL(entriesFound(QList<Entry*>)), SLOT(collectEntries(QList<Entry*>)));
+    QSignalSpy finishedSpy(&asyncSearcher, SIGNAL(searchFinished()));
+    m_searchResult.clear();
+    asyncSearcher.search("MATCH", root, Qt::CaseInsensitive);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(m_searchResult, expected);
+
+    QList<const Group*> groups;
+    groups.append(root);
+    QCOMPARE(ParallelEntryFilter::entries(groups).size(), 10 * ParallelEntryFilter::MinChunkSize);
+    QCOMPARE(ParallelEntryFilter::entries(groups, true).size(), 9 * ParallelEntryFilter::MinChunkSize);
+
+    delete root;
+}
+
+void TestEntrySearcher::benchmarkIndexedSearch()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    QScopedPointer<Database> db(new Database());
+    for (int i = 0; i < 100; i++) {
+        Group* group = new Group();
+        group->setParent(db->rootGroup());
+
+        for (int j = 0; j < 1000; j++) {
+            Entry* entry = new Entry();
+            entry->setTitle(QString("Entry %1-%2").arg(i).arg(j));
+            entry->setUsername(QString("user%1@example.com").arg(j));
+            entry->setUrl(QString("https://www.site%1.example.com/login").arg(i * 1000 + j));
+            entry->setNotes("Lorem ipsum dolor sit amet, consectetur adipiscing elit.");
+            entry->setGroup(group);
+        }
+    }
+
+    // build the index
+    m_searchResult = m_entrySearcher.search("site", db->rootGroup(), Qt::CaseInsensitive);
+    QCOMPARE(m_searchResult.size(), 100000);
+
+    QBENCHMARK {
+        m_searchResult = m_entrySearcher.search("site4242", db->rootGroup(), Qt::CaseInsensitive);
+    }
+    QCOMPARE(m_searchResult.size(), 11);
+}
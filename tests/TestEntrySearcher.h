@@ -21,6 +21,7 @@
 
 #include <QObject>
 
+#include "core/AsyncEntrySearcher.h"
 #include "core/EntrySearcher.h"
 #include "core/Group.h"
 
@@ -35,6 +36,13 @@ private Q_SLOTS:
     void testAndConcatenationInSearch();
     void testSearch();
     void testAllAttributesAreSearched();
+    void testIndexedSearch();
+    void testAsyncSearch();
+    void testParallelSearch();
+    void benchmarkIndexedSearch();
+
+public Q_SLOTS:
+    void collectEntries(const QList<Entry*>& entries);
 
 private:
     Group* m_groupRoot;
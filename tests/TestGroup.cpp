@@ -25,6 +25,7 @@
 #include "core/Database.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/TreeIterator.h"
 #include "crypto/Crypto.h"
 
 QTEST_GUILESS_MAIN(TestGroup)
@@ -442,3 +443,233 @@ void TestGroup::testCopyCustomIcons()
     QCOMPARE(metaTarget->customIcon(group1Icon).pixel(0, 0), qRgb(1, 2, 3));
     QCOMPARE(metaTarget->customIcon(group2Icon).pixel(0, 0), qRgb(4, 5, 6));
 }
+
+void TestGroup::testResolveUuid()
+{
+    QScopedPointer<Database> db(new Database());
+    Group* root = db->rootGroup();
+    QCOMPARE(db->resolveGroup(root->uuid()), root);
+
+    Group* group1 = new Group();
+    group1->setUuid(Uuid::random());
+    Group* group2 = new Group();
+    group2->setUuid(Uuid::random());
+    group2->setParent(group1);
+    Entry* entry = new Entry();
+    entry->setUuid(Uuid::random());
+    entry->setGroup(group2);
+
+    // not part of the database yet
+    QVERIFY(!db->resolveGroup(group1->uuid()));
+    QVERIFY(!db->resolveEntry(entry->uuid()));
+
+    group1->setParent(root);
+    QCOMPARE(db->resolveGroup(group1->uuid()), group1);
+    QCOMPARE(db->resolveGroup(group2->uuid()), group2);
+    QCOMPARE(db->resolveEntry(entry->uuid()), entry);
+
+    Uuid oldUuid = entry->uuid();
+    entry->setUuid(Uuid::random());
+    QVERIFY(!db->resolveEntry(oldUuid));
+    QCOMPARE(db->resolveEntry(entry->uuid()), entry);
+
+    oldUuid = group2->uuid();
+    group2->setUuid(Uuid::random());
+    QVERIFY(!db->resolveGroup(oldUuid));
+    QCOMPARE(db->resolveGroup(group2->uuid()), group2);
+
+    // history items aren't part of the index
+    entry->beginUpdate();
+    entry->setTitle("new title");
+    entry->endUpdate();
+    QCOMPARE(entry->historyItems().size(), 1);
+    QCOMPARE(db->resolveEntry(entry->uuid()), entry);
+
+    // moving to another database
+    QScopedPointer<Database> db2(new Database());
+    group1->setParent(db2->rootGroup());
+    QVERIFY(!db->resolveGroup(group1->uuid()));
+    QVERIFY(!db->resolveGroup(group2->uuid()));
+    QVERIFY(!db->resolveEntry(entry->uuid()));
+    QCOMPARE(db2->resolveGroup(group1->uuid()), group1);
+    QCOMPARE(db2->resolveGroup(group2->uuid()), group2);
+    QCOMPARE(db2->resolveEntry(entry->uuid()), entry);
+
+    entry->setGroup(db->rootGroup());
+    QVERIFY(!db2->resolveEntry(entry->uuid()));
+    QCOMPARE(db->resolveEntry(entry->uuid()), entry);
+
+    Uuid entryUuid = entry->uuid();
+    delete entry;
+    QVERIFY(!db->resolveEntry(entryUuid));
+
+    Uuid group2Uuid = group2->uuid();
+    delete group2;
+    QVERIFY(!db2->resolveGroup(group2Uuid));
+}
+
+void TestGroup::testTreeIterators()
+{
+    // root
+    // - group1 (entry1 with two history items, entry2)
+    //   - group11 (entry3)
+    // - group2
+    //   - group21 (entry4 with one history item)
+    Group* root = new Group();
+    Group* group1 = new Group();
+    group1->setParent(root);
+    Group* group11 = new Group();
+    group11->setParent(group1);
+    Group* group2 = new Group();
+    group2->setParent(root);
+    Group* group21 = new Group();
+    group21->setParent(group2);
+
+    Entry* entry1 = new Entry();
+    entry1->setGroup(group1);
+    Entry* history11 = new Entry();
+    entry1->addHistoryItem(history11);
+    Entry* history12 = new Entry();
+    entry1->addHistoryItem(history12);
+    Entry* entry2 = new Entry();
+    entry2->setGroup(group1);
+    Entry* entry3 = new Entry();
+    entry3->setGroup(group11);
+    Entry* entry4 = new Entry();
+    entry4->setGroup(group21);
+    Entry* history41 = new Entry();
+    entry4->addHistoryItem(history41);
+
+    QList<const Group*> groups;
+    GroupIterator groupIterator(root);
+    while (groupIterator.hasNext()) {
+        groups.append(groupIterator.next());
+    }
+    QCOMPARE(groups, QList<const Group*>() << root << group1 << group11 << group2 << group21);
+    QCOMPARE(root->groupsRecursive(true), groups);
+    QCOMPARE(root->groupsRecursive(false), groups.mid(1));
+    QCOMPARE(group11->groupsRecursive(true), QList<const Group*>() << group11);
+    QVERIFY(!GroupIterator(group11, false).hasNext());
+
+    groups.clear();
+    GroupIterator skipIterator(root);
+    while (skipIterator.hasNext()) {
+        const Group* group = skipIterator.next();
+        groups.append(group);
+        if (group == group1) {
+            skipIterator.skipChildren();
+        }
+    }
+    QCOMPARE(groups, QList<const Group*>() << root << group1 << group2 << group21);
+
+    QCOMPARE(root->entriesRecursive(), QList<Entry*>() << entry1 << entry2 << entry3 << entry4);
+    QCOMPARE(root->entriesRecursive(true), QList<Entry*>() << entry1 << entry2 << history11 << history12
+                                                          << entry3 << entry4 << history41);
+    QCOMPARE(group2->entriesRecursive(true), QList<Entry*>() << entry4 << history41);
+
+    delete root;
+}
+
+void TestGroup::testResolveInheritance()
+{
+    Group* root = new Group();
+    Group* group1 = new Group();
+    group1->setParent(root);
+    Group* group11 = new Group();
+    group11->setParent(group1);
+    Group* group2 = new Group();
+    group2->setParent(root);
+
+    QVERIFY(group11->resolveSearchingEnabled());
+    QVERIFY(group11->resolveAutoTypeEnabled());
+    QCOMPARE(group11->resolveDefaultAutoTypeSequence(), QString());
+
+    root->setDefaultAutoTypeSequence("{root}");
+    group1->setSearchingEnabled(Group::Disable);
+    group1->setAutoTypeEnabled(Group::Disable);
+    QVERIFY(!group11->resolveSearchingEnabled());
+    QVERIFY(!group11->resolveAutoTypeEnabled());
+    QCOMPARE(group11->resolveDefaultAutoTypeSequence(), QString("{root}"));
+    QVERIFY(group2->resolveSearchingEnabled());
+
+    group11->setAutoTypeEnabled(Group::Enable);
+    group1->setDefaultAutoTypeSequence("{group1}");
+    QVERIFY(!group11->resolveSearchingEnabled());
+    QVERIFY(group11->resolveAutoTypeEnabled());
+    QCOMPARE(group11->resolveDefaultAutoTypeSequence(), QString("{group1}"));
+
+    // moving a group takes the settings of the new parent
+    group11->setParent(group2);
+    QVERIFY(group11->resolveSearchingEnabled());
+    QCOMPARE(group11->resolveDefaultAutoTypeSequence(), QString("{root}"));
+
+    group2->copyDataFrom(group1);
+    QVERIFY(!group11->resolveSearchingEnabled());
+    QVERIFY(group11->resolveAutoTypeEnabled());
+    QCOMPARE(group11->resolveDefaultAutoTypeSequence(), QString("{group1}"));
+
+    group11->setDefaultAutoTypeSequence("{group11}");
+    group2->setSearchingEnabled(Group::Inherit);
+    QVERIFY(group11->resolveSearchingEnabled());
+    QCOMPARE(group11->resolveDefaultAutoTypeSequence(), QString("{group11}"));
+
+    delete root;
+}
+
+void TestGroup::benchmarkResolveEntry_data()
+{
+    QTest::addColumn<bool>("useIndex");
+
+    QTest::newRow("Index")     << true;
+    QTest::newRow("Tree walk") << false;
+}
+
+void TestGroup::benchmarkResolveEntry()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    QFETCH(bool, useIndex);
+
+    // 100 groups with 1000 entries each
+    QScopedPointer<Database> db(new Database());
+    QList<Uuid> uuids;
+    for (int i = 0; i < 100; i++) {
+        Group* group = new Group();
+        group->setUuid(Uuid::random());
+        group->setParent(db->rootGroup());
+
+        for (int j = 0; j < 1000; j++) {
+            Entry* entry = new Entry();
+            entry->setUuid(Uuid::random());
+            entry->setGroup(group);
+
+            if (j % 100 == 0) {
+                uuids.append(entry->uuid());
+            }
+        }
+    }
+
+    QBENCHMARK {
+        Q_FOREACH (const Uuid& uuid, uuids) {
+            Entry* result = Q_NULLPTR;
+
+            if (useIndex) {
+                result = db->resolveEntry(uuid);
+            }
+            else {
+                Q_FOREACH (Entry* entry, db->rootGroup()->entriesRecursive()) {
+                    if (entry->uuid() == uuid) {
+                        result = entry;
+                        break;
+                    }
+                }
+            }
+
+            QVERIFY(result);
+        }
+    }
+}
@@ -33,6 +33,11 @@ private Q_SLOTS:
     void testCopyCustomIcon();
     void testClone();
     void testCopyCustomIcons();
+    void testResolveUuid();
+    void testTreeIterators();
+    void testResolveInheritance();
+    void benchmarkResolveEntry_data();
+    void benchmarkResolveEntry();
 };
 
 #endif // KEEPASSX_TESTGROUP_H
@@ -22,6 +22,7 @@
 
 #include "tests.h"
 #include "crypto/Crypto.h"
+#include "crypto/Random.h"
 #include "streams/HashedBlockStream.h"
 
 QTEST_GUILESS_MAIN(TestHashedBlockStream)
@@ -71,3 +72,41 @@ void TestHashedBlockStream::testWriteRead()
     buffer.reset();
     buffer.buffer().clear();
 }
+
+void TestHashedBlockStream::testConcurrent()
+{
+    QByteArray data = randomGen()->randomArray(100 * 64 + 10);
+
+    QBuffer bufferSerial;
+    bufferSerial.open(QIODevice::ReadWrite);
+    HashedBlockStream writerSerial(&bufferSerial, 64);
+    writerSerial.open(QIODevice::WriteOnly);
+    QCOMPARE(writerSerial.write(data), static_cast<qint64>(data.size()));
+    writerSerial.close();
+
+    QBuffer bufferConcurrent;
+    bufferConcurrent.open(QIODevice::ReadWrite);
+    HashedBlockStream writerConcurrent(&bufferConcurrent, 64);
+    writerConcurrent.setConcurrentBlocks(4);
+    writerConcurrent.open(QIODevice::WriteOnly);
+    QCOMPARE(writerConcurrent.write(data), static_cast<qint64>(data.size()));
+    writerConcurrent.close();
+
+    QCOMPARE(bufferConcurrent.data(), bufferSerial.data());
+
+    bufferConcurrent.reset();
+    HashedBlockStream reader(&bufferConcurrent);
+    reader.setConcurrentBlocks(4);
+    reader.open(QIODevice::ReadOnly);
+    QCOMPARE(reader.readAll(), data);
+
+    // corrupt the payload of block 50, everything before it has to be delivered
+    QByteArray& rawData = bufferConcurrent.buffer();
+    int corruptPos = 50 * (40 + 64) + 40;
+    rawData[corruptPos] = static_cast<char>(rawData.at(corruptPos) ^ 0x01);
+    bufferConcurrent.reset();
+    QVERIFY(reader.reset());
+
+    QCOMPARE(reader.read(50 * 64), data.left(50 * 64));
+    QVERIFY(reader.read(1).isEmpty());
+}
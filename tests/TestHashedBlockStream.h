@@ -27,6 +27,7 @@ class TestHashedBlockStream : public QObject
 private Q_SLOTS:
     void initTestCase();
     void testWriteRead();
+    void testConcurrent();
 };
 
 #endif // KEEPASSX_TESTHASHEDBLOCKSTREAM_H
@@ -17,6 +17,8 @@
 
 #include "TestKeePass2Reader.h"
 
+#include <QBuffer>
+#include <QFile>
 #include <QTest>
 
 #include "config-keepassx-tests.h"
@@ -26,6 +28,7 @@
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "format/KeePass2Reader.h"
+#include "format/KeePass2Writer.h"
 #include "keys/PasswordKey.h"
 
 QTEST_GUILESS_MAIN(TestKeePass2Reader)
@@ -156,3 +159,177 @@ void TestKeePass2Reader::testFormat300()
 
     delete db;
 }
+
+void TestKeePass2Reader::testTransformedKey()
+{
+    QString filename = QString(KEEPASSX_TEST_DATA_DIR).append("/Format300.kdbx");
+    CompositeKey key;
+    key.addKey(PasswordKey("a"));
+    KeePass2Reader reader;
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray transformSeed;
+    quint64 transformRounds;
+    QVERIFY(reader.readTransformParameters(&file, &transformSeed, &transformRounds));
+    QCOMPARE(transformSeed.size(), 32);
+    file.close();
+
+    QByteArray transformedKey = key.transform(transformSeed, transformRounds);
+
+    // the transformed key is used instead of the key
+    reader.setTransformedKey(transformSeed, transformRounds, QByteArray(32, 'X'));
+    QScopedPointer<Database> db(reader.readDatabase(filename, key));
+    QVERIFY(!db);
+    QVERIFY(reader.hasError());
+
+    reader.setTransformedKey(transformSeed, transformRounds, transformedKey);
+    db.reset(reader.readDatabase(filename, key));
+    QVERIFY(db);
+    QVERIFY(!reader.hasError());
+    QCOMPARE(db->transformRounds(), transformRounds);
+    QCOMPARE(db->transformedMasterKey(), transformedKey);
+
+    // ignored if it doesn't belong to the database
+    reader.setTransformedKey(QByteArray(32, 'X'), transformRounds, QByteArray(32, 'X'));
+    db.reset(reader.readDatabase(filename, key));
+    QVERIFY(db);
+    QVERIFY(!reader.hasError());
+}
+
+void TestKeePass2Reader::testPipelined_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QString>("password");
+    QTest::newRow("Uncompressed") << QString("NonAscii.kdbx") << QString::fromUtf8("\xce\x94\xc3\xb6\xd8\xb6");
+    QTest::newRow("Compressed") << QString("Compressed.kdbx") << QString("");
+    QTest::newRow("Format300") << QString("Format300.kdbx") << QString("a");
+}
+
+void TestKeePass2Reader::testPipelined()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QString, password);
+
+    QString filename = QString(KEEPASSX_TEST_DATA_DIR).append("/").append(fileName);
+    CompositeKey key;
+    key.addKey(PasswordKey(password));
+
+    KeePass2Reader readerSerial;
+    readerSerial.setPipelined(false);
+    readerSerial.setSaveXml(true);
+    Database* dbSerial = readerSerial.readDatabase(filename, key);
+    QVERIFY(dbSerial);
+    QVERIFY(!readerSerial.hasError());
+
+    KeePass2Reader readerPipelined;
+    readerPipelined.setPipelined(true);
+    readerPipelined.setSaveXml(true);
+    Database* dbPipelined = readerPipelined.readDatabase(filename, key);
+    QVERIFY(dbPipelined);
+    QVERIFY(!readerPipelined.hasError());
+
+    QVERIFY(!readerPipelined.xmlData().isEmpty());
+    QCOMPARE(readerPipelined.xmlData(), readerSerial.xmlData());
+    QCOMPARE(dbPipelined->rootGroup()->name(), dbSerial->rootGroup()->name());
+
+    delete dbSerial;
+    delete dbPipelined;
+}
+
+void TestKeePass2Reader::testPipelinedCorrupted()
+{
+    CompositeKey key;
+    key.addKey(PasswordKey("test"));
+
+    Database dbOrg;
+    dbOrg.setTransformRounds(1);
+    dbOrg.setKey(key);
+    dbOrg.setCompressionAlgo(Database::CompressionNone);
+    dbOrg.metadata()->setName("Corrupted");
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    writer.writeDatabase(&buffer, &dbOrg);
+    QVERIFY(!writer.hasError());
+
+    // flip a bit inside the hashed xml block
+    QByteArray& data = buffer.buffer();
+    int corruptPos = data.size() - 200;
+    data[corruptPos] = static_cast<char>(data.at(corruptPos) ^ 0x01);
+    buffer.seek(0);
+
+    // all stages have to shut down without reading the rest of the file
+    KeePass2Reader reader;
+    reader.setPipelined(true);
+    Database* db = reader.readDatabase(&buffer, key);
+    QVERIFY(!db);
+    QVERIFY(reader.hasError());
+}
+
+void TestKeePass2Reader::benchmarkReadDatabase_data()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::addColumn<bool>("pipelined");
+    QTest::newRow("1k serial") << 1000 << false;
+    QTest::newRow("1k pipelined") << 1000 << true;
+    QTest::newRow("10k serial") << 10000 << false;
+    QTest::newRow("10k pipelined") << 10000 << true;
+    QTest::newRow("100k serial") << 100000 << false;
+    QTest::newRow("100k pipelined") << 100000 << true;
+}
+
+void TestKeePass2Reader::benchmarkReadDatabase()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    QFETCH(int, entryCount);
+    QFETCH(bool, pipelined);
+
+    CompositeKey key;
+    key.addKey(PasswordKey("test"));
+
+    Database dbOrg;
+    dbOrg.setTransformRounds(1);
+    dbOrg.setKey(key);
+
+    Group* group = Q_NULLPTR;
+    for (int i = 0; i < entryCount; i++) {
+        if ((i % 100) == 0) {
+            group = new Group();
+            group->setUuid(Uuid::random());
+            group->setName(QString("Group %1").arg(i / 100));
+            group->setParent(dbOrg.rootGroup());
+        }
+
+        Entry* entry = new Entry();
+        entry->setUuid(Uuid::random());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setUsername(QString("user%1").arg(i));
+        entry->setPassword(QString("password%1").arg(i));
+        entry->setUrl(QString("https://example.com/%1").arg(i));
+        entry->setNotes(QString("Notes of entry %1").arg(i));
+        entry->setGroup(group);
+    }
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    writer.writeDatabase(&buffer, &dbOrg);
+    QVERIFY(!writer.hasError());
+
+    KeePass2Reader reader;
+    reader.setPipelined(pipelined);
+
+    QBENCHMARK {
+        buffer.seek(0);
+        Database* db = reader.readDatabase(&buffer, key);
+        QVERIFY(db);
+        delete db;
+    }
+}
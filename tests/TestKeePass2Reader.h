@@ -32,6 +32,12 @@ private Q_SLOTS:
     void testBrokenHeaderHash();
     void testFormat200();
     void testFormat300();
+    void testTransformedKey();
+    void testPipelined_data();
+    void testPipelined();
+    void testPipelinedCorrupted();
+    void benchmarkReadDatabase_data();
+    void benchmarkReadDatabase();
 };
 
 #endif // KEEPASSX_TESTKEEPASS2READER_H
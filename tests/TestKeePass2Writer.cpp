@@ -25,6 +25,7 @@
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "crypto/Random.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/PasswordKey.h"
@@ -101,6 +102,57 @@ void TestKeePass2Writer::testNonAsciiPasswords()
     QCOMPARE(m_dbTest->rootGroup()->entries()[0]->password(), m_dbOrg->rootGroup()->entries()[0]->password());
 }
 
+void TestKeePass2Writer::testLargeAttachment_data()
+{
+    QTest::addColumn<int>("compression");
+
+    QTest::newRow("None") << static_cast<int>(Database::CompressionNone);
+    QTest::newRow("GZip") << static_cast<int>(Database::CompressionGZip);
+}
+
+void TestKeePass2Writer::testLargeAttachment()
+{
+    QFETCH(int, compression);
+
+    CompositeKey key;
+    key.addKey(PasswordKey("test"));
+
+    Database db;
+    db.setKey(key);
+    db.setCompressionAlgo(static_cast<Database::CompressionAlgorithm>(compression));
+
+    // not a multiple of the chunk size of the base64 encoder
+    QByteArray random = randomGen()->randomArray(1024 * 1024 + 1);
+    QByteArray repeated(2 * 1024 * 1024 + 2, 'x');
+    Entry* entry = new Entry();
+    entry->setUuid(Uuid::random());
+    entry->attachments()->set("random.bin", random);
+    entry->attachments()->set("repeated.bin", repeated);
+    entry->setGroup(db.rootGroup());
+
+    QImage icon(64, 64, QImage::Format_RGB32);
+    icon.fill(qRgb(11, 22, 33));
+    Uuid iconUuid = Uuid::random();
+    db.metadata()->addCustomIcon(iconUuid, icon);
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+
+    KeePass2Writer writer;
+    writer.writeDatabase(&buffer, &db);
+    QVERIFY(!writer.hasError());
+    buffer.seek(0);
+    KeePass2Reader reader;
+    QScopedPointer<Database> dbRead(reader.readDatabase(&buffer, key));
+    QVERIFY(!reader.hasError());
+    QVERIFY(dbRead);
+
+    Entry* entryRead = dbRead->rootGroup()->entries().at(0);
+    QCOMPARE(entryRead->attachments()->value("random.bin"), random);
+    QCOMPARE(entryRead->attachments()->value("repeated.bin"), repeated);
+    QCOMPARE(dbRead->metadata()->customIcon(iconUuid).convertToFormat(QImage::Format_RGB32), icon);
+}
+
 void TestKeePass2Writer::cleanupTestCase()
 {
     delete m_dbOrg;
@@ -17,6 +17,7 @@
 
 #include "TestKeePass2XmlReader.h"
 
+#include <QBuffer>
 #include <QFile>
 #include <QTest>
 
@@ -24,8 +25,11 @@
 #include "core/Database.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Entry.h"
 #include "crypto/Crypto.h"
+#include "crypto/Random.h"
 #include "format/KeePass2XmlReader.h"
+#include "streams/QtIOCompressor"
 #include "config-keepassx-tests.h"
 
 QTEST_GUILESS_MAIN(TestKeePass2XmlReader)
@@ -395,6 +399,102 @@ void TestKeePass2XmlReader::testBroken_data()
     QTest::newRow("BrokenDeletedObjects (not strict)") << "BrokenDeletedObjects" << false << false;
 }
 
+void TestKeePass2XmlReader::testBinaries()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(bool, compressed);
+    QFETCH(bool, corrupt);
+
+    QByteArray rawData = data;
+    if (compressed) {
+        QBuffer buffer(&rawData);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        QtIOCompressor compressor(&buffer);
+        compressor.setStreamFormat(QtIOCompressor::GzipFormat);
+        QVERIFY(compressor.open(QIODevice::WriteOnly));
+        QCOMPARE(compressor.write(data), qint64(data.size()));
+        compressor.close();
+    }
+    if (corrupt) {
+        rawData.chop(rawData.size() / 2);
+    }
+
+    // split the character data at an offset that isn't a multiple of 4
+    // so the decoder has to carry state from one chunk to the next
+    QByteArray base64 = rawData.toBase64();
+    int split = base64.size() / 2 | 1;
+    QByteArray text = base64.left(split) + "<!-- split -->\n" + base64.mid(split);
+
+    QByteArray xml;
+    xml.append("<KeePassFile><Meta><Binaries><Binary ID=\"0\" Compressed=\"");
+    xml.append(compressed ? "True" : "False");
+    xml.append("\">");
+    xml.append(text);
+    xml.append("</Binary></Binaries></Meta><Root><Group>");
+    xml.append("<UUID>AAAAAAAAAAAAAAAAAAAAAA==</UUID><Name>Root</Name>");
+    xml.append("<Entry><UUID>AQAAAAAAAAAAAAAAAAAAAA==</UUID>");
+    xml.append("<Binary><Key>attachment</Key><Value Ref=\"0\" /></Binary>");
+    xml.append("</Entry></Group></Root></KeePassFile>");
+
+    QBuffer buffer(&xml);
+    buffer.open(QIODevice::ReadOnly);
+    KeePass2XmlReader reader;
+    QScopedPointer<Database> db(reader.readDatabase(&buffer));
+
+    if (corrupt) {
+        QVERIFY(reader.hasError());
+        QCOMPARE(reader.errorString(), QString("Unable to decompress binary"));
+    }
+    else {
+        QVERIFY2(!reader.hasError(), reader.errorString().toUtf8().constData());
+        QVERIFY(db);
+        QCOMPARE(db->rootGroup()->entries().size(), 1);
+        Entry* entry = db->rootGroup()->entries().at(0);
+        QVERIFY(entry->attachments()->value("attachment") == data);
+    }
+}
+
+void TestKeePass2XmlReader::testBinaries_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("compressed");
+    QTest::addColumn<bool>("corrupt");
+
+    QByteArray random = randomGen()->randomArray(1024 * 1024 + 1);
+    QByteArray repeated = QByteArray("0123456789abcdef").repeated(128 * 1024);
+
+    QTest::newRow("Empty")                << QByteArray() << false << false;
+    QTest::newRow("Small")                << QByteArray("a") << false << false;
+    QTest::newRow("Random")               << random << false << false;
+    QTest::newRow("Compressed small")     << QByteArray("ab") << true << false;
+    QTest::newRow("Compressed random")    << random << true << false;
+    QTest::newRow("Compressed repeated")  << repeated << true << false;
+    QTest::newRow("Compressed truncated") << repeated << true << true;
+}
+
+void TestKeePass2XmlReader::testEmptyCompressedBinary()
+{
+    QByteArray xml;
+    xml.append("<KeePassFile><Meta><Binaries><Binary ID=\"0\" Compressed=\"True\"></Binary>");
+    xml.append("</Binaries></Meta><Root><Group>");
+    xml.append("<UUID>AAAAAAAAAAAAAAAAAAAAAA==</UUID><Name>Root</Name>");
+    xml.append("<Entry><UUID>AQAAAAAAAAAAAAAAAAAAAA==</UUID>");
+    xml.append("<Binary><Key>attachment</Key><Value Ref=\"0\" /></Binary>");
+    xml.append("</Entry></Group></Root></KeePassFile>");
+
+    QBuffer buffer(&xml);
+    buffer.open(QIODevice::ReadOnly);
+    KeePass2XmlReader reader;
+    QScopedPointer<Database> db(reader.readDatabase(&buffer));
+
+    QVERIFY2(!reader.hasError(), reader.errorString().toUtf8().constData());
+    QVERIFY(db);
+    QCOMPARE(db->rootGroup()->entries().size(), 1);
+    Entry* entry = db->rootGroup()->entries().at(0);
+    QVERIFY(entry->attachments()->hasKey("attachment"));
+    QVERIFY(entry->attachments()->value("attachment").isEmpty());
+}
+
 void TestKeePass2XmlReader::cleanupTestCase()
 {
     delete m_db;
@@ -41,6 +41,9 @@ private Q_SLOTS:
     void testDeletedObjects();
     void testBroken();
     void testBroken_data();
+    void testBinaries();
+    void testBinaries_data();
+    void testEmptyCompressedBinary();
     void cleanupTestCase();
 
 private:
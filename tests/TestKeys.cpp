@@ -18,6 +18,7 @@
 #include "TestKeys.h"
 
 #include <QBuffer>
+#include <QSignalSpy>
 #include <QTest>
 
 #include "config-keepassx-tests.h"
@@ -29,7 +30,9 @@
 #include "format/KeePass2Writer.h"
 #include "keys/CompositeKey.h"
 #include "keys/FileKey.h"
+#include "keys/KeyTransformer.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 
 QTEST_GUILESS_MAIN(TestKeys)
 
@@ -167,6 +170,92 @@ void TestKeys::testFileKeyError()
     errorMsg = "";
 }
 
+void TestKeys::testKeyTransformer()
+{
+    CompositeKey compositeKey;
+    compositeKey.addKey(PasswordKey("test"));
+    QByteArray seed(32, '\x4B');
+    quint64 rounds = 2 * KeyTransformer::RoundsPerStep + 5;
+
+    KeyTransformer transformer;
+    QSignalSpy spyProgress(&transformer, SIGNAL(progress(quint64)));
+    transformer.transform(compositeKey, seed, rounds);
+    QVERIFY(transformer.wait());
+
+    QVERIFY(!transformer.isCanceled());
+    QCOMPARE(transformer.transformedKey(), compositeKey.transform(seed, rounds));
+    QCOMPARE(transformer.key().rawKey(), compositeKey.rawKey());
+    QCOMPARE(transformer.seed(), seed);
+    QCOMPARE(transformer.rounds(), rounds);
+
+    QCOMPARE(spyProgress.count(), 3);
+    QCOMPARE(spyProgress.at(0).at(0).value<quint64>(), KeyTransformer::RoundsPerStep);
+    QCOMPARE(spyProgress.at(2).at(0).value<quint64>(), rounds);
+}
+
+void TestKeys::testKeyTransformerCancel()
+{
+    CompositeKey compositeKey;
+    compositeKey.addKey(PasswordKey("test"));
+
+    KeyTransformer transformer;
+    transformer.transform(compositeKey, QByteArray(32, '\x4B'), Q_UINT64_C(1000000000000));
+    transformer.cancel();
+    QVERIFY(transformer.wait());
+
+    QVERIFY(transformer.isCanceled());
+    QVERIFY(transformer.transformedKey().isEmpty());
+}
+
+void TestKeys::testTransformedKeyCache()
+{
+    TransformedKeyCache* cache = transformedKeyCache();
+    CompositeKey key;
+    key.addKey(PasswordKey("test"));
+    CompositeKey otherKey;
+    otherKey.addKey(PasswordKey("other"));
+    QByteArray seed(32, '\x4B');
+    QByteArray transformedKey(32, '\x7E');
+
+    // disabled by default
+    QCOMPARE(cache->lifetime(), 0);
+    cache->insert(key, seed, 1000, transformedKey);
+    QVERIFY(cache->transformedKey(key, seed, 1000).isEmpty());
+
+    cache->setLifetime(60);
+    cache->insert(key, seed, 1000, transformedKey);
+    QCOMPARE(cache->transformedKey(key, seed, 1000), transformedKey);
+    QVERIFY(cache->transformedKey(otherKey, seed, 1000).isEmpty());
+    QVERIFY(cache->transformedKey(key, QByteArray(32, '\x4C'), 1000).isEmpty());
+    QVERIFY(cache->transformedKey(key, seed, 1001).isEmpty());
+
+    // Database::setKey() uses the cached key
+    Database db;
+    db.setTransformRounds(1000);
+    db.setKey(key, seed);
+    QCOMPARE(db.transformedMasterKey(), transformedKey);
+
+    // and adds keys it transformed itself
+    db.setKey(otherKey, seed);
+    QCOMPARE(cache->transformedKey(otherKey, seed, 1000), otherKey.transform(seed, 1000));
+
+    // the oldest entries are replaced when the cache is full
+    for (int i = 0; i < TransformedKeyCache::MaxEntries; i++) {
+        cache->insert(key, seed, 2000 + i, transformedKey);
+    }
+    QVERIFY(cache->transformedKey(key, seed, 1000).isEmpty());
+    QVERIFY(cache->transformedKey(otherKey, seed, 1000).isEmpty());
+    QVERIFY(!cache->transformedKey(key, seed, 2000).isEmpty());
+    QVERIFY(!cache->transformedKey(key, seed, 2000 + TransformedKeyCache::MaxEntries - 1).isEmpty());
+
+    cache->purge();
+    QVERIFY(cache->transformedKey(key, seed, 2000).isEmpty());
+
+    cache->insert(key, seed, 1000, transformedKey);
+    cache->setLifetime(0);
+    QVERIFY(cache->transformedKey(key, seed, 1000).isEmpty());
+}
+
 void TestKeys::benchmarkTransformKey()
 {
     QByteArray env = qgetenv("BENCHMARK");
@@ -31,6 +31,9 @@ private Q_SLOTS:
     void testFileKey_data();
     void testCreateFileKey();
     void testFileKeyError();
+    void testKeyTransformer();
+    void testKeyTransformerCancel();
+    void testTransformedKeyCache();
     void benchmarkTransformKey();
 };
 
@@ -468,3 +468,38 @@ void TestModified::testHistoryItem()
 
     delete db;
 }
+
+void TestModified::testBatchUpdate()
+{
+    Database* db = new Database();
+    Group* root = db->rootGroup();
+    Entry* entry1 = new Entry();
+    entry1->setGroup(root);
+    Entry* entry2 = new Entry();
+    entry2->setGroup(root);
+
+    QSignalSpy spyModified(db, SIGNAL(modifiedImmediate()));
+    QSignalSpy spyDataChanged(db, SIGNAL(entryDataChanged(Entry*)));
+
+    db->beginBatchUpdate();
+    entry1->setTitle("a");
+    entry2->setTitle("b");
+    entry1->setNotes("c");
+    QCOMPARE(spyModified.count(), 0);
+    QCOMPARE(spyDataChanged.count(), 3);
+    db->endBatchUpdate();
+    QCOMPARE(spyModified.count(), 1);
+
+    // entries that have been moved to another database don't notify this one
+    Database* db2 = new Database();
+    entry2->setGroup(db2->rootGroup());
+    int modifiedCount = spyModified.count();
+    QSignalSpy spyModified2(db2, SIGNAL(modifiedImmediate()));
+    entry2->setTitle("d");
+    QCOMPARE(spyModified.count(), modifiedCount);
+    QCOMPARE(spyDataChanged.count(), 3);
+    QCOMPARE(spyModified2.count(), 1);
+
+    delete db;
+    delete db2;
+}
@@ -30,6 +30,7 @@ private Q_SLOTS:
     void testGroupSets();
     void testEntrySets();
     void testHistoryItem();
+    void testBatchUpdate();
 };
 
 #endif // KEEPASSX_TESTMODIFIED_H
@@ -21,7 +21,9 @@
 #include <QTest>
 
 #include "tests.h"
+#include "crypto/AesKdf.h"
 #include "crypto/Crypto.h"
+#include "crypto/Random.h"
 #include "crypto/SymmetricCipher.h"
 #include "streams/SymmetricCipherStream.h"
 
@@ -194,3 +196,138 @@ void TestSymmetricCipher::testPadding()
     QByteArray decrypted = streamDec.readAll();
     QCOMPARE(decrypted, plainText);
 }
+
+void TestSymmetricCipher::testAesKdf_data()
+{
+    QTest::addColumn<quint64>("rounds");
+
+    QTest::newRow("1") << Q_UINT64_C(1);
+    QTest::newRow("2") << Q_UINT64_C(2);
+    QTest::newRow("6000") << Q_UINT64_C(6000);
+}
+
+void TestSymmetricCipher::testAesKdf()
+{
+    QFETCH(quint64, rounds);
+
+    QByteArray seed = randomGen()->randomArray(32);
+    QByteArray key = randomGen()->randomArray(32);
+
+    // ECB mode encrypts both halves independently
+    QByteArray expected = key;
+    SymmetricCipher cipher(SymmetricCipher::Aes256, SymmetricCipher::Ecb, SymmetricCipher::Encrypt,
+                           seed, QByteArray(16, 0));
+    cipher.processInPlace(expected, rounds);
+
+    AesKdf kdf(seed);
+    kdf.processInPlace(key, rounds);
+    QCOMPARE(key, expected);
+
+    // transforming in steps gives the same result
+    kdf.processInPlace(key, rounds);
+    cipher.processInPlace(expected, rounds);
+    QCOMPARE(key, expected);
+}
+
+void TestSymmetricCipher::testStreamChunkSize_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::newRow("Empty") << 0;
+    QTest::newRow("Partial block") << 10;
+    QTest::newRow("One block") << 16;
+    QTest::newRow("Partial chunk") << 1000;
+    QTest::newRow("One chunk") << SymmetricCipherStream::BulkChunkSize;
+    QTest::newRow("Multiple chunks") << (3 * SymmetricCipherStream::BulkChunkSize + 5);
+}
+
+void TestSymmetricCipher::testStreamChunkSize()
+{
+    QFETCH(int, size);
+
+    QByteArray key = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    QByteArray iv = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+    QByteArray plainText = randomGen()->randomArray(size);
+
+    // the bulk path must produce the same output as the block by block path
+    QBuffer bufferBlock;
+    bufferBlock.open(QIODevice::WriteOnly);
+    SymmetricCipherStream streamEncBlock(&bufferBlock, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
+                                         SymmetricCipher::Encrypt, key, iv);
+    streamEncBlock.open(QIODevice::WriteOnly);
+    QCOMPARE(streamEncBlock.write(plainText), static_cast<qint64>(size));
+    streamEncBlock.close();
+
+    QBuffer bufferBulk;
+    bufferBulk.open(QIODevice::WriteOnly);
+    SymmetricCipherStream streamEncBulk(&bufferBulk, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
+                                        SymmetricCipher::Encrypt, key, iv,
+                                        SymmetricCipherStream::BulkChunkSize);
+    streamEncBulk.open(QIODevice::WriteOnly);
+    QCOMPARE(streamEncBulk.write(plainText), static_cast<qint64>(size));
+    streamEncBulk.close();
+
+    QCOMPARE(bufferBulk.data().size(), size - (size % 16) + 16);
+    QCOMPARE(bufferBulk.data(), bufferBlock.data());
+
+    QByteArray cipherText = bufferBulk.data();
+    QBuffer bufferDec(&cipherText);
+    bufferDec.open(QIODevice::ReadOnly);
+    SymmetricCipherStream streamDecBulk(&bufferDec, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
+                                        SymmetricCipher::Decrypt, key, iv,
+                                        SymmetricCipherStream::BulkChunkSize);
+    streamDecBulk.open(QIODevice::ReadOnly);
+
+    // read in odd sizes to cross chunk boundaries
+    QByteArray decrypted;
+    QByteArray part;
+    do {
+        part = streamDecBulk.read(4099);
+        decrypted.append(part);
+    } while (!part.isEmpty());
+
+    QCOMPARE(decrypted, plainText);
+}
+
+void TestSymmetricCipher::benchmarkStream_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::newRow("Block") << 0;
+    QTest::newRow("Bulk") << SymmetricCipherStream::BulkChunkSize;
+}
+
+void TestSymmetricCipher::benchmarkStream()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    QFETCH(int, chunkSize);
+
+    // 16 MiB per iteration, divide by the reported time to get MB/s
+    const int size = 16 * 1024 * 1024;
+
+    QByteArray key = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    QByteArray iv = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+    QByteArray plainText(size, '\x4B');
+    QByteArray cipherText;
+
+    QBENCHMARK {
+        QBuffer bufferEnc;
+        bufferEnc.open(QIODevice::WriteOnly);
+        SymmetricCipherStream streamEnc(&bufferEnc, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
+                                        SymmetricCipher::Encrypt, key, iv, chunkSize);
+        streamEnc.open(QIODevice::WriteOnly);
+        streamEnc.write(plainText);
+        streamEnc.close();
+        cipherText = bufferEnc.data();
+
+        QBuffer bufferDec(&cipherText);
+        bufferDec.open(QIODevice::ReadOnly);
+        SymmetricCipherStream streamDec(&bufferDec, SymmetricCipher::Aes256, SymmetricCipher::Cbc,
+                                        SymmetricCipher::Decrypt, key, iv, chunkSize);
+        streamDec.open(QIODevice::ReadOnly);
+        QCOMPARE(streamDec.readAll().size(), size);
+    }
+}
@@ -30,6 +30,12 @@ private Q_SLOTS:
     void testAes256CbcDecryption();
     void testSalsa20();
     void testPadding();
+    void testAesKdf_data();
+    void testAesKdf();
+    void testStreamChunkSize_data();
+    void testStreamChunkSize();
+    void benchmarkStream_data();
+    void benchmarkStream();
 };
 
 #endif // KEEPASSX_TESTSYMMETRICCIPHER_H
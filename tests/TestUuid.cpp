@@ -0,0 +1,147 @@
+/*
+ *  Copyright (C) 2016 Felix Geyer <debfx@fobos.de>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestUuid.h"
+
+#include <QDataStream>
+#include <QSet>
+#include <QTest>
+
+#include "tests.h"
+#include "core/Uuid.h"
+#include "crypto/Crypto.h"
+
+QTEST_GUILESS_MAIN(TestUuid)
+
+void TestUuid::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void TestUuid::testConversion()
+{
+    QByteArray data = QByteArray::fromHex("00112233445566778899aabbccddeeff");
+    Uuid uuid(data);
+
+    QVERIFY(!uuid.isNull());
+    QCOMPARE(uuid.toByteArray(), data);
+    QCOMPARE(uuid.toHex(), QString("00112233445566778899aabbccddeeff"));
+    QCOMPARE(uuid.toBase64(), QString::fromLatin1(data.toBase64()));
+    QCOMPARE(Uuid::fromBase64(uuid.toBase64()), uuid);
+
+    QVERIFY(Uuid().isNull());
+    QCOMPARE(Uuid().toByteArray(), QByteArray(Uuid::Length, 0));
+    QVERIFY(Uuid(QByteArray(Uuid::Length, 0)).isNull());
+
+    // only the last byte is set
+    QByteArray lastByte(Uuid::Length, 0);
+    lastByte[Uuid::Length - 1] = 1;
+    QVERIFY(!Uuid(lastByte).isNull());
+}
+
+void TestUuid::testCompare()
+{
+    Uuid uuid1 = Uuid::random();
+    Uuid uuid2 = Uuid::random();
+    Uuid uuid1Copy(uuid1.toByteArray());
+
+    QVERIFY(uuid1 == uuid1Copy);
+    QVERIFY(!(uuid1 != uuid1Copy));
+    QVERIFY(uuid1 != uuid2);
+    QCOMPARE(qHash(uuid1), qHash(uuid1Copy));
+
+    // uuids that differ in one half only
+    QByteArray data(Uuid::Length, 0);
+    data[0] = 1;
+    Uuid firstHalf(data);
+    data[0] = 0;
+    data[Uuid::Length - 1] = 1;
+    Uuid secondHalf(data);
+    QVERIFY(firstHalf != secondHalf);
+    QVERIFY(qHash(firstHalf) != qHash(secondHalf));
+
+    QSet<Uuid> set;
+    set.insert(uuid1);
+    set.insert(uuid1Copy);
+    set.insert(uuid2);
+    set.insert(firstHalf);
+    set.insert(secondHalf);
+    QCOMPARE(set.size(), 4);
+}
+
+void TestUuid::testDataStream()
+{
+    Uuid uuid = Uuid::random();
+
+    QByteArray data;
+    QDataStream writeStream(&data, QIODevice::WriteOnly);
+    writeStream << uuid;
+
+    Uuid readUuid;
+    QDataStream readStream(data);
+    readStream >> readUuid;
+    QCOMPARE(readUuid, uuid);
+}
+
+void TestUuid::benchmarkLoad()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    QStringList strings;
+    for (int i = 0; i < 100000; i++) {
+        strings.append(Uuid::random().toBase64());
+    }
+
+    QBENCHMARK {
+        QHash<Uuid, int> uuids;
+        for (int i = 0; i < strings.size(); i++) {
+            uuids.insert(Uuid::fromBase64(strings.at(i)), i);
+        }
+        QCOMPARE(uuids.size(), strings.size());
+    }
+}
+
+void TestUuid::benchmarkLookup()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.", SkipAll);
+    }
+
+    QHash<Uuid, int> uuids;
+    QList<Uuid> keys;
+    for (int i = 0; i < 100000; i++) {
+        Uuid uuid = Uuid::random();
+        uuids.insert(uuid, i);
+        keys.append(uuid);
+    }
+
+    QBENCHMARK {
+        int found = 0;
+        for (int i = 0; i < keys.size(); i++) {
+            if (uuids.contains(keys.at(i))) {
+                found++;
+            }
+        }
+        QCOMPARE(found, keys.size());
+    }
+}
@@ -46,6 +46,8 @@ void TestWildcardMatcher::testMatcher_data()
     QTest::newRow("MatchJustWildcard") << DefaultText << QString("*") << true;
     QTest::newRow("MatchFollowingWildcards") << DefaultText << QString("some t**t") << true;
     QTest::newRow("CaseSensitivity") << DefaultText.toUpper() << QString("some t**t") << true;
+    QTest::newRow("NoMatchOverlappingStartAndEnd") << DefaultText << QString("some text*text") << false;
+    QTest::newRow("NoMatchOverlappingMiddleAndEnd") << AlternativeText << QString("some*other text*text") << false;
 }
 
 void TestWildcardMatcher::testMatcher()
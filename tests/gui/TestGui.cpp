@@ -70,6 +70,9 @@ void TestGui::testOpenDatabase()
 
     QTest::keyClicks(editPassword, "a");
     QTest::keyClick(editPassword, Qt::Key_Enter);
+
+    // the key is transformed in the background
+    QTRY_VERIFY(!m_mainWindow->findChild<QWidget*>("databaseOpenWidget"));
 }
 
 void TestGui::testTabs()